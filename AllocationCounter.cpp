@@ -0,0 +1,66 @@
+#include "AllocationCounter.h"
+
+#if defined(BLOCKDROP_COUNT_ALLOCATIONS)
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace BlockDrop
+{
+
+namespace
+{
+
+std::atomic<uint64_t> s_AllocationCount{};
+thread_local uint64_t s_ThreadAllocationCount{};
+
+}
+
+uint64_t GetAllocationCount()
+{
+	return s_AllocationCount.load(std::memory_order_relaxed);
+}
+
+uint64_t GetThreadAllocationCount()
+{
+	return s_ThreadAllocationCount;
+}
+
+}
+
+// The array and nothrow forms call these by default, so they're counted too
+void* operator new(std::size_t size)
+{
+	BlockDrop::s_AllocationCount.fetch_add(1, std::memory_order_relaxed);
+	BlockDrop::s_ThreadAllocationCount++;
+	if (size == 0)
+	{
+		size = 1;
+	}
+	while (true)
+	{
+		if (void* memory = std::malloc(size))
+		{
+			return memory;
+		}
+		std::new_handler handler = std::get_new_handler();
+		if (handler == nullptr)
+		{
+			throw std::bad_alloc();
+		}
+		handler();
+	}
+}
+
+void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+	std::free(memory);
+}
+
+#endif
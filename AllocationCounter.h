@@ -0,0 +1,64 @@
+#pragma once
+#ifndef BLOCKDROP_ALLOCATION_COUNTER_H
+#define BLOCKDROP_ALLOCATION_COUNTER_H
+
+#include <cstdint>
+
+namespace BlockDrop
+{
+
+#if defined(BLOCKDROP_COUNT_ALLOCATIONS)
+
+// Calls to the global operator new so far, from every thread. Only built with
+// BLOCKDROP_COUNT_ALLOCATIONS defined, which replaces operator new and delete
+// with malloc and free plus a relaxed counter; over-aligned allocations
+// aren't counted.
+uint64_t GetAllocationCount();
+// The same, from the calling thread only
+uint64_t GetThreadAllocationCount();
+
+#else
+
+// Without BLOCKDROP_COUNT_ALLOCATIONS nothing is counted and every
+// AllocationScope reads zero
+inline uint64_t GetAllocationCount() { return 0; }
+inline uint64_t GetThreadAllocationCount() { return 0; }
+
+#endif
+
+// Counts allocations from when it's made, or last reset; scope one around a
+// frame to see what the frame allocates. Counts every thread, or only the
+// one it's made on, leaving out others such as a video encoder's.
+class AllocationScope
+{
+public:
+	enum class Threads
+	{
+		All,
+		Current,
+	};
+
+public:
+	explicit AllocationScope(Threads threads = Threads::All)
+		: m_Threads(threads)
+		, m_Start(Now())
+	{
+	}
+
+	void Reset() { m_Start = Now(); }
+	uint64_t GetCount() const { return Now() - m_Start; }
+
+private:
+	uint64_t Now() const
+	{
+		return m_Threads == Threads::All ? GetAllocationCount() : GetThreadAllocationCount();
+	}
+
+private:
+	Threads m_Threads;
+	uint64_t m_Start;
+};
+
+}
+
+#endif
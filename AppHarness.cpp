@@ -0,0 +1,104 @@
+#include "AppHarness.h"
+
+namespace BlockDrop
+{
+
+AppHarness::AppHarness(Replay const& script)
+	: m_Script(script)
+	, m_App(script.GetSeed())
+{
+}
+
+bool AppHarness::Start()
+{
+	return m_Driver.Start(App::ScreenWidthPx, App::s_ScreenHeightPx);
+}
+
+bool AppHarness::Step()
+{
+	UiState uiState = m_App.GetUiState();
+	if (uiState != m_LastUiState)
+	{
+		m_GamesOver += uiState == UiState::GameOver;
+		m_ScoresEntered += m_LastUiState == UiState::ScoreboardEntry;
+		m_LastUiState = uiState;
+		m_ScreenFrame = 0;
+	}
+
+	// Past the end of a screen's keys, nothing is held
+	auto screenKeys = [&](Replay const& screenScript) -> ReplayKeys {
+		return m_ScreenFrame < screenScript.GetFrameCount() ? screenScript.GetKeys(m_ScreenFrame) : 0;
+	};
+
+	ReplayKeys keys = 0;
+	switch (uiState)
+	{
+	case UiState::Game:
+	{
+		if (m_Script.GetFrameCount() > 0)
+		{
+			keys = m_Script.GetKeys(m_PlayFrame % m_Script.GetFrameCount());
+		}
+		m_PlayFrame++;
+	} break;
+	case UiState::GameOver:
+	{
+		keys = screenKeys(m_GameOverScript);
+	} break;
+	case UiState::ScoreboardEntry:
+	{
+		keys = screenKeys(m_ScoreboardEntryScript);
+	} break;
+	}
+	m_ScreenFrame++;
+
+	m_Driver.SetKeys(keys);
+	bool bRunning = m_Driver.Step(m_Script.GetFrameTime());
+	m_Frames.push_back({ uiState, m_Driver.GetUserUpdateSeconds() });
+	return bRunning;
+}
+
+bool AppHarness::Run(size_t frameCount)
+{
+	m_Frames.reserve(m_Frames.size() + frameCount);
+	for (size_t frame = 0; frame < frameCount; ++frame)
+	{
+		if (!Step())
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+Replay AppHarness::MakeGameOverScript()
+{
+	// Half a second on the game over text
+	Replay result;
+	result.AddFrames(0, 30);
+	result.AddFrames(ReplayKeyBit(olc::ENTER));
+	return result;
+}
+
+Replay AppHarness::MakeScoreboardEntryScript()
+{
+	Replay result;
+	auto tap = [&](olc::Key key) {
+		result.AddFrames(ReplayKeyBit(key));
+		result.AddFrames(0, 5);
+	};
+
+	result.AddFrames(0, 10);
+	tap(olc::UP);
+	tap(olc::UP);
+	tap(olc::RIGHT);
+	// Long enough to repeat a few times
+	result.AddFrames(ReplayKeyBit(olc::DOWN), 30);
+	result.AddFrames(0, 5);
+	tap(olc::RIGHT);
+	tap(olc::UP);
+	result.AddFrames(ReplayKeyBit(olc::ENTER));
+	return result;
+}
+
+}
@@ -0,0 +1,79 @@
+#pragma once
+#ifndef BLOCKDROP_APP_HARNESS_H
+#define BLOCKDROP_APP_HARNESS_H
+
+#include <cstdint>
+#include <vector>
+
+#include "Game.h"
+#include "HeadlessDriver.h"
+#include "Replay.h"
+
+namespace BlockDrop
+{
+
+// One frame of an AppHarness run
+struct AppFrame
+{
+	// Screen the frame started on
+	UiState m_UiState{};
+	double m_UserUpdateSeconds{};
+};
+
+// The whole App run headless on scripted input, for end to end timings:
+// every frame goes through OnUserUpdate() as in the game, UI state machine,
+// Sim step, drawing and all.
+//
+// Play follows the script, which moves on only while a game is in progress.
+// When a game ends the harness answers the end of game screens itself, as a
+// player would, since a script can't know when they'll come up: Enter past
+// game over, then a name spun in with Up, Down (held, to repeat) and Right,
+// and Enter again to start the next game.
+//
+// The App has a fixed seed and steps its Sim on the engine thread, so the
+// same script plays the same way every run.
+class AppHarness
+{
+public:
+	explicit AppHarness(Replay const& script);
+
+	// Needs tile.png in the working directory
+	bool Start();
+	// Runs one frame; returns false once the App has exited
+	bool Step();
+	// Step()s frameCount times; false if the App exits first
+	bool Run(size_t frameCount);
+
+	App const& GetApp() const { return m_App; }
+	// Every frame stepped, in order
+	std::vector<AppFrame> const& GetFrames() const { return m_Frames; }
+	int GetGamesOver() const { return m_GamesOver; }
+	int GetScoresEntered() const { return m_ScoresEntered; }
+
+private:
+	// Keys for a screen, played from its first frame
+	static Replay MakeGameOverScript();
+	static Replay MakeScoreboardEntryScript();
+
+private:
+	Replay const& m_Script;
+	Replay const m_GameOverScript{ MakeGameOverScript() };
+	Replay const m_ScoreboardEntryScript{ MakeScoreboardEntryScript() };
+
+	// The driver attaches to the most recently constructed engine, so comes
+	// after the App
+	App m_App;
+	HeadlessDriver m_Driver{};
+
+	std::vector<AppFrame> m_Frames{};
+	// Frames of play so far, and of the current screen
+	size_t m_PlayFrame{};
+	size_t m_ScreenFrame{};
+	UiState m_LastUiState{ UiState::Game };
+	int m_GamesOver{};
+	int m_ScoresEntered{};
+};
+
+}
+
+#endif
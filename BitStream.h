@@ -0,0 +1,149 @@
+#pragma once
+#ifndef BLOCKDROP_BIT_STREAM_H
+#define BLOCKDROP_BIT_STREAM_H
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace BlockDrop
+{
+
+// Number of bits needed to store any value in [0, maxValue]
+constexpr int BitsFor(uint32_t maxValue)
+{
+	int bits = 0;
+	while (maxValue > 0)
+	{
+		bits++;
+		maxValue >>= 1;
+	}
+	return bits;
+}
+
+// Appends values LSB-first to a byte buffer.
+class BitWriter
+{
+public:
+	explicit BitWriter(std::vector<uint8_t>& out)
+		: m_Out(out)
+	{
+	}
+
+	void Write(uint32_t value, int bitCount)
+	{
+		assert(bitCount >= 0 && bitCount <= 32);
+		for (int i = 0; i < bitCount; ++i)
+		{
+			if (m_BitOffset == 0)
+			{
+				m_Out.push_back(0);
+			}
+			m_Out.back() |= static_cast<uint8_t>(((value >> i) & 1) << m_BitOffset);
+			m_BitOffset = (m_BitOffset + 1) & 7;
+		}
+	}
+
+	void WriteBool(bool value)
+	{
+		Write(value ? 1 : 0, 1);
+	}
+
+	// 7 bits per group, high bit set while more groups follow
+	void WriteVarUInt(uint32_t value)
+	{
+		do
+		{
+			uint32_t group = value & 0x7F;
+			value >>= 7;
+			Write(group | (value != 0 ? 0x80 : 0), 8);
+		} while (value != 0);
+	}
+
+	void WriteFloat(float value)
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		Write(bits, 32);
+	}
+
+private:
+	std::vector<uint8_t>& m_Out;
+	int m_BitOffset{};
+};
+
+// Reads values written by BitWriter. Reading past the end yields zeroes and
+// sets the overrun flag rather than throwing.
+class BitReader
+{
+public:
+	BitReader(uint8_t const* data, size_t size)
+		: m_Data(data)
+		, m_Size(size)
+	{
+	}
+
+	explicit BitReader(std::vector<uint8_t> const& data)
+		: BitReader(data.data(), data.size())
+	{
+	}
+
+	uint32_t Read(int bitCount)
+	{
+		assert(bitCount >= 0 && bitCount <= 32);
+		uint32_t value = 0;
+		for (int i = 0; i < bitCount; ++i)
+		{
+			size_t byte = m_BitPosition >> 3;
+			if (byte >= m_Size)
+			{
+				m_bOverrun = true;
+				return value;
+			}
+			value |= static_cast<uint32_t>((m_Data[byte] >> (m_BitPosition & 7)) & 1) << i;
+			m_BitPosition++;
+		}
+		return value;
+	}
+
+	bool ReadBool()
+	{
+		return Read(1) != 0;
+	}
+
+	uint32_t ReadVarUInt()
+	{
+		uint32_t value = 0;
+		for (int shift = 0; shift < 35; shift += 7)
+		{
+			uint32_t group = Read(8);
+			value |= (group & 0x7F) << shift;
+			if ((group & 0x80) == 0)
+			{
+				break;
+			}
+		}
+		return value;
+	}
+
+	float ReadFloat()
+	{
+		uint32_t bits = Read(32);
+		float value;
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	bool IsOverrun() const { return m_bOverrun; }
+
+private:
+	uint8_t const* m_Data;
+	size_t m_Size;
+	size_t m_BitPosition{};
+	bool m_bOverrun{ false };
+};
+
+}
+
+#endif
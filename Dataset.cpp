@@ -0,0 +1,89 @@
+#include "Dataset.h"
+
+#include <cstring>
+
+namespace BlockDrop
+{
+
+DatasetRecord MakeDatasetRecord(PackedBoard const& board, TetronimoInstance const& placement, int score)
+{
+	DatasetRecord record{};
+	record.m_Board = board;
+	record.m_Score = score;
+	record.m_Piece = placement.GetTileColor();
+	record.m_Rotation = static_cast<uint8_t>(placement.GetRotationIndex());
+	record.m_Column = static_cast<int8_t>(placement.GetPosition().x);
+	record.m_Row = static_cast<int8_t>(placement.GetPosition().y);
+	return record;
+}
+
+size_t EncodeDatasetRecord(DatasetRecord const& record, uint8_t* out)
+{
+	uint8_t bytes[sizeof(DatasetRecord)];
+	std::memcpy(bytes, &record, sizeof(bytes));
+
+	size_t written = 0;
+	size_t i = 0;
+	while (i < sizeof(bytes))
+	{
+		size_t run = i;
+		while (run < sizeof(bytes) && bytes[run] == 0 && run - i < 128)
+		{
+			run++;
+		}
+		if (run - i >= 2)
+		{
+			out[written++] = static_cast<uint8_t>(0x80 | (run - i - 1));
+			i = run;
+			continue;
+		}
+
+		// Literals up to the next pair of zeroes
+		size_t end = i;
+		while (end < sizeof(bytes) && end - i < 128
+			&& !(bytes[end] == 0 && end + 1 < sizeof(bytes) && bytes[end + 1] == 0))
+		{
+			end++;
+		}
+		out[written++] = static_cast<uint8_t>(end - i - 1);
+		std::memcpy(out + written, bytes + i, end - i);
+		written += end - i;
+		i = end;
+	}
+
+	return written;
+}
+
+bool DecodeDatasetRecord(uint8_t const* in, size_t size, DatasetRecord& out)
+{
+	uint8_t* bytes = reinterpret_cast<uint8_t*>(&out);
+	size_t written = 0;
+	size_t i = 0;
+	while (i < size)
+	{
+		uint8_t control = in[i++];
+		size_t count = (control & 0x7F) + 1;
+		if (written + count > sizeof(DatasetRecord))
+		{
+			return false;
+		}
+		if (control & 0x80)
+		{
+			std::memset(bytes + written, 0, count);
+		}
+		else
+		{
+			if (i + count > size)
+			{
+				return false;
+			}
+			std::memcpy(bytes + written, in + i, count);
+			i += count;
+		}
+		written += count;
+	}
+
+	return written == sizeof(DatasetRecord);
+}
+
+}
@@ -0,0 +1,81 @@
+#pragma once
+#ifndef BLOCKDROP_DATASET_H
+#define BLOCKDROP_DATASET_H
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#include "PackedBoard.h"
+#include "Sim.h"
+
+namespace BlockDrop
+{
+
+// Self-play training data: one record per placed piece, written in shards by
+// DatasetWriter and read back by DatasetReader.
+//
+// Shard layout (little-endian, structs written as-is):
+//   block 0 .. block N-1
+//   DatasetBlockIndex[N]
+//   DatasetFooter
+//
+// Each block holds up to s_DatasetRecordsPerBlock records, compressed one at a
+// time so a single record can be decoded without touching its neighbours:
+//   uint32_t recordCount
+//   uint16_t recordEnd[recordCount]   end of each record, relative to the payload
+//   payload                           EncodeDatasetRecord() output, back to back
+static_assert(std::endian::native == std::endian::little, "Dataset files are little-endian");
+
+static constexpr uint32_t s_DatasetMagic = 0x53444442; // "BDDS"
+static constexpr uint32_t s_DatasetVersion = 1;
+static constexpr uint32_t s_DatasetRecordsPerBlock = 1024;
+static constexpr char s_DatasetShardExtension[] = ".bds";
+
+// Board before the piece was placed, where it went, and how the game ended.
+struct DatasetRecord
+{
+	PackedBoard m_Board{};
+	// Score when the piece spawned and when the game ended
+	int32_t m_Score{};
+	int32_t m_FinalScore{};
+	TileColor m_Piece{};
+	uint8_t m_Rotation{};
+	int8_t m_Column{};
+	int8_t m_Row{};
+	uint8_t m_Reserved[4]{};
+};
+static_assert(sizeof(DatasetRecord) == 56);
+
+struct DatasetBlockIndex
+{
+	uint64_t m_Offset{};
+	uint32_t m_Size{};
+	uint32_t m_RecordCount{};
+	// Records in all earlier blocks of the shard
+	uint64_t m_FirstRecord{};
+};
+
+struct DatasetFooter
+{
+	uint32_t m_Magic{ s_DatasetMagic };
+	uint32_t m_Version{ s_DatasetVersion };
+	uint32_t m_RecordSize{ sizeof(DatasetRecord) };
+	uint32_t m_BlockCount{};
+	uint64_t m_RecordCount{};
+};
+
+// m_FinalScore is left at zero; DatasetWriter::Producer::EndGame() fills it in
+DatasetRecord MakeDatasetRecord(PackedBoard const& board, TetronimoInstance const& placement, int score);
+
+// Zero-run-length coding: a control byte 0x80 | (n - 1) stands for n zero
+// bytes, otherwise n - 1 followed by n literal bytes. Boards are mostly empty
+// rows, so records typically shrink to a third of their size.
+static constexpr size_t s_MaxEncodedRecordSize = sizeof(DatasetRecord) + (sizeof(DatasetRecord) + 127) / 128;
+
+size_t EncodeDatasetRecord(DatasetRecord const& record, uint8_t* out);
+bool DecodeDatasetRecord(uint8_t const* in, size_t size, DatasetRecord& out);
+
+}
+
+#endif
@@ -0,0 +1,167 @@
+#include "DatasetReader.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(_MSC_VER)
+	#include <xmmintrin.h>
+	#define BLOCKDROP_PREFETCH(address) _mm_prefetch(reinterpret_cast<char const*>(address), _MM_HINT_T0)
+#else
+	#define BLOCKDROP_PREFETCH(address) __builtin_prefetch(address)
+#endif
+
+namespace BlockDrop
+{
+
+bool DatasetReader::AddShard(std::string const& path)
+{
+	Shard shard{};
+	if (!shard.m_File.OpenReadOnly(path) || shard.m_File.Size() < sizeof(DatasetFooter))
+	{
+		return false;
+	}
+
+	uint8_t const* data = shard.m_File.Data();
+	size_t size = shard.m_File.Size();
+
+	DatasetFooter footer{};
+	std::memcpy(&footer, data + size - sizeof(footer), sizeof(footer));
+	if (footer.m_Magic != s_DatasetMagic
+		|| footer.m_Version != s_DatasetVersion
+		|| footer.m_RecordSize != sizeof(DatasetRecord)
+		|| static_cast<uint64_t>(footer.m_BlockCount) * sizeof(DatasetBlockIndex) > size - sizeof(footer))
+	{
+		return false;
+	}
+
+	// The index sits at an arbitrary offset, so copy it out rather than
+	// reading it in place
+	size_t indexOffset = size - sizeof(footer) - footer.m_BlockCount * sizeof(DatasetBlockIndex);
+	shard.m_Blocks.resize(footer.m_BlockCount);
+	std::memcpy(shard.m_Blocks.data(), data + indexOffset, footer.m_BlockCount * sizeof(DatasetBlockIndex));
+	for (auto const& block : shard.m_Blocks)
+	{
+		if (block.m_Offset + block.m_Size > indexOffset
+			|| block.m_RecordCount > s_DatasetRecordsPerBlock
+			|| sizeof(uint32_t) + block.m_RecordCount * sizeof(uint16_t) > block.m_Size)
+		{
+			return false;
+		}
+	}
+
+	// Samples land anywhere, so read-ahead would only waste cache
+	shard.m_File.Advise(MappedFile::Advice::Random);
+	shard.m_File.Advise(MappedFile::Advice::WillNeed);
+
+	shard.m_FirstRecord = m_RecordCount;
+	shard.m_RecordCount = footer.m_RecordCount;
+	m_RecordCount += footer.m_RecordCount;
+	m_Shards.push_back(std::move(shard));
+	return true;
+}
+
+DatasetReader::Location DatasetReader::Locate(uint64_t index) const
+{
+	auto shardIt = std::upper_bound(m_Shards.begin(), m_Shards.end(), index,
+		[](uint64_t i, Shard const& shard) { return i < shard.m_FirstRecord; });
+	if (shardIt == m_Shards.begin())
+	{
+		return {};
+	}
+	Shard const& shard = *std::prev(shardIt);
+	uint64_t shardIndex = index - shard.m_FirstRecord;
+
+	auto blockIt = std::upper_bound(shard.m_Blocks.begin(), shard.m_Blocks.end(), shardIndex,
+		[](uint64_t i, DatasetBlockIndex const& block) { return i < block.m_FirstRecord; });
+	if (blockIt == shard.m_Blocks.begin())
+	{
+		return {};
+	}
+	DatasetBlockIndex const& block = *std::prev(blockIt);
+	uint32_t recordInBlock = static_cast<uint32_t>(shardIndex - block.m_FirstRecord);
+	if (recordInBlock >= block.m_RecordCount)
+	{
+		return {};
+	}
+
+	uint8_t const* blockData = shard.m_File.Data() + block.m_Offset;
+	uint8_t const* recordEnds = blockData + sizeof(uint32_t);
+	size_t headerSize = sizeof(uint32_t) + block.m_RecordCount * sizeof(uint16_t);
+
+	uint16_t start = 0;
+	uint16_t end = 0;
+	if (recordInBlock > 0)
+	{
+		std::memcpy(&start, recordEnds + (recordInBlock - 1) * sizeof(uint16_t), sizeof(start));
+	}
+	std::memcpy(&end, recordEnds + recordInBlock * sizeof(uint16_t), sizeof(end));
+	if (end < start || headerSize + end > block.m_Size)
+	{
+		return {};
+	}
+
+	return { blockData + headerSize + start, static_cast<size_t>(end - start) };
+}
+
+bool DatasetReader::Read(uint64_t index, DatasetRecord& out) const
+{
+	Location location = Locate(index);
+	return location.m_Data != nullptr && DecodeDatasetRecord(location.m_Data, location.m_Size, out);
+}
+
+size_t DatasetReader::SampleBatch(DatasetRecord* out, size_t count, std::mt19937_64& rng) const
+{
+	if (m_RecordCount == 0)
+	{
+		return 0;
+	}
+
+	std::uniform_int_distribution<uint64_t> pick(0, m_RecordCount - 1);
+	Location groups[2][s_PrefetchDistance];
+	auto resolve = [&](Location* group, size_t groupSize) {
+		for (size_t i = 0; i < groupSize; ++i)
+		{
+			group[i] = Locate(pick(rng));
+			if (group[i].m_Data != nullptr)
+			{
+				// A record can straddle two cache lines
+				BLOCKDROP_PREFETCH(group[i].m_Data);
+				BLOCKDROP_PREFETCH(group[i].m_Data + group[i].m_Size - 1);
+			}
+		}
+	};
+
+	// Resolve and prefetch the next group of records before decoding this
+	// one, so its cache lines arrive while this group decodes
+	size_t decoded = 0;
+	size_t groupSize = std::min(s_PrefetchDistance, count);
+	resolve(groups[0], groupSize);
+	for (size_t groupStart = 0, current = 0; groupStart < count; groupStart += s_PrefetchDistance, current ^= 1)
+	{
+		size_t nextStart = groupStart + s_PrefetchDistance;
+		size_t nextSize = nextStart < count ? std::min(s_PrefetchDistance, count - nextStart) : 0;
+		resolve(groups[current ^ 1], nextSize);
+
+		Location const* group = groups[current];
+		for (size_t i = 0; i < groupSize; ++i)
+		{
+			if (group[i].m_Data != nullptr && DecodeDatasetRecord(group[i].m_Data, group[i].m_Size, out[decoded]))
+			{
+				decoded++;
+			}
+		}
+		groupSize = nextSize;
+	}
+
+	return decoded;
+}
+
+void DatasetReader::WarmPageCache() const
+{
+	for (auto const& shard : m_Shards)
+	{
+		shard.m_File.Advise(MappedFile::Advice::WillNeed);
+	}
+}
+
+}
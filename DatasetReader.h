@@ -0,0 +1,72 @@
+#pragma once
+#ifndef BLOCKDROP_DATASET_READER_H
+#define BLOCKDROP_DATASET_READER_H
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Dataset.h"
+#include "MappedFile.h"
+
+namespace BlockDrop
+{
+
+// Random access over shards written by DatasetWriter. Shards are memory
+// mapped and records are decoded straight into caller-provided storage, so
+// reading never allocates. Const methods are safe to call from many threads,
+// each with its own RNG.
+class DatasetReader
+{
+public:
+	// Records per group in SampleBatch; each group is resolved and prefetched
+	// while the one before it decodes
+	static constexpr size_t s_PrefetchDistance = 32;
+
+public:
+	DatasetReader() = default;
+	DatasetReader(DatasetReader&) = delete;
+
+	// Maps a shard and checks its footer. Returns false, leaving the reader
+	// unchanged, if the file is missing or not a complete shard.
+	bool AddShard(std::string const& path);
+
+	uint64_t GetRecordCount() const { return m_RecordCount; }
+	int GetShardCount() const { return static_cast<int>(m_Shards.size()); }
+
+	bool Read(uint64_t index, DatasetRecord& out) const;
+
+	// Fills out[0, count) with records drawn uniformly (with replacement) from
+	// every shard. Returns how many were decoded, which is only short of count
+	// if a shard is corrupt.
+	size_t SampleBatch(DatasetRecord* out, size_t count, std::mt19937_64& rng) const;
+
+	// Asks the OS to pull every shard into the page cache. Cheap to repeat, so
+	// long-running trainers can call it periodically to keep pages resident.
+	void WarmPageCache() const;
+
+private:
+	struct Shard
+	{
+		MappedFile m_File;
+		std::vector<DatasetBlockIndex> m_Blocks;
+		uint64_t m_FirstRecord{};
+		uint64_t m_RecordCount{};
+	};
+
+	struct Location
+	{
+		uint8_t const* m_Data{};
+		size_t m_Size{};
+	};
+
+	Location Locate(uint64_t index) const;
+
+private:
+	std::vector<Shard> m_Shards;
+	uint64_t m_RecordCount{};
+};
+
+}
+
+#endif
@@ -0,0 +1,303 @@
+#include "DatasetWriter.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace BlockDrop
+{
+
+struct DatasetWriter::Block
+{
+	std::vector<DatasetRecord> m_Records;
+	Block* m_Next{};
+};
+
+void DatasetWriter::Producer::Add(DatasetRecord const& record)
+{
+	m_Game.push_back(record);
+}
+
+void DatasetWriter::Producer::EndGame(int finalScore)
+{
+	for (DatasetRecord& record : m_Game)
+	{
+		record.m_FinalScore = finalScore;
+		Push(record);
+	}
+	m_Game.clear();
+}
+
+void DatasetWriter::Producer::Push(DatasetRecord const& record)
+{
+	if (m_Block == nullptr)
+	{
+		m_Block = m_Writer.AcquireBlock();
+	}
+
+	m_Block->m_Records.push_back(record);
+	if (m_Block->m_Records.size() == s_DatasetRecordsPerBlock)
+	{
+		m_Writer.Submit(m_Block);
+		m_Block = nullptr;
+	}
+}
+
+void DatasetWriter::Producer::Flush()
+{
+	if (m_Block == nullptr)
+	{
+		return;
+	}
+
+	if (m_Block->m_Records.empty())
+	{
+		m_Writer.ReleaseBlocks(m_Block, m_Block);
+	}
+	else
+	{
+		m_Writer.Submit(m_Block);
+	}
+	m_Block = nullptr;
+}
+
+DatasetWriter::DatasetWriter(std::string const& pathPrefix, size_t shardSizeBytes, int workerCount)
+	: m_PathPrefix(pathPrefix)
+	, m_ShardSizeBytes(shardSizeBytes)
+{
+	for (int i = 0; i < std::max(1, workerCount); ++i)
+	{
+		m_Workers.emplace_back(&DatasetWriter::WorkerLoop, this);
+	}
+}
+
+DatasetWriter::~DatasetWriter()
+{
+	Close();
+
+	Block* block = m_Free.exchange(nullptr);
+	while (block != nullptr)
+	{
+		Block* next = block->m_Next;
+		delete block;
+		block = next;
+	}
+}
+
+bool DatasetWriter::Close()
+{
+	if (m_bClosing.exchange(true))
+	{
+		return m_Error.empty();
+	}
+
+	m_Signal.fetch_add(1, std::memory_order_release);
+	m_Signal.notify_all();
+	for (auto& worker : m_Workers)
+	{
+		worker.join();
+	}
+	m_Workers.clear();
+
+	FinishShard();
+	return m_Error.empty();
+}
+
+DatasetWriter::Block* DatasetWriter::AcquireBlock()
+{
+	// Take the whole free list, keep one and give the rest back
+	Block* block = m_Free.exchange(nullptr, std::memory_order_acquire);
+	if (block == nullptr)
+	{
+		block = new Block();
+		block->m_Records.reserve(s_DatasetRecordsPerBlock);
+		return block;
+	}
+
+	if (block->m_Next != nullptr)
+	{
+		Block* last = block->m_Next;
+		while (last->m_Next != nullptr)
+		{
+			last = last->m_Next;
+		}
+		ReleaseBlocks(block->m_Next, last);
+	}
+	block->m_Next = nullptr;
+	block->m_Records.clear();
+	return block;
+}
+
+void DatasetWriter::ReleaseBlocks(Block* first, Block* last)
+{
+	last->m_Next = m_Free.load(std::memory_order_relaxed);
+	while (!m_Free.compare_exchange_weak(last->m_Next, first, std::memory_order_release, std::memory_order_relaxed))
+	{
+	}
+}
+
+void DatasetWriter::Submit(Block* block)
+{
+	block->m_Next = m_Pending.load(std::memory_order_relaxed);
+	while (!m_Pending.compare_exchange_weak(block->m_Next, block, std::memory_order_release, std::memory_order_relaxed))
+	{
+	}
+
+	m_Signal.fetch_add(1, std::memory_order_release);
+	m_Signal.notify_one();
+}
+
+void DatasetWriter::WorkerLoop()
+{
+	std::vector<uint8_t> encoded;
+	while (true)
+	{
+		uint32_t seen = m_Signal.load(std::memory_order_acquire);
+		Block* batch = m_Pending.exchange(nullptr, std::memory_order_acquire);
+		if (batch == nullptr)
+		{
+			if (m_bClosing.load(std::memory_order_acquire))
+			{
+				return;
+			}
+			m_Signal.wait(seen, std::memory_order_acquire);
+			continue;
+		}
+
+		// The list is newest-first; write in submission order
+		Block* ordered = nullptr;
+		while (batch != nullptr)
+		{
+			Block* next = batch->m_Next;
+			batch->m_Next = ordered;
+			ordered = batch;
+			batch = next;
+		}
+
+		Block* first = ordered;
+		Block* last = ordered;
+		for (Block* block = ordered; block != nullptr; block = block->m_Next)
+		{
+			EncodeBlock(*block, encoded);
+			AppendBlock(encoded, static_cast<uint32_t>(block->m_Records.size()));
+			last = block;
+		}
+		ReleaseBlocks(first, last);
+	}
+}
+
+void DatasetWriter::EncodeBlock(Block const& block, std::vector<uint8_t>& encoded) const
+{
+	uint32_t count = static_cast<uint32_t>(block.m_Records.size());
+	size_t headerSize = sizeof(uint32_t) + count * sizeof(uint16_t);
+	encoded.resize(headerSize + count * s_MaxEncodedRecordSize);
+
+	std::memcpy(encoded.data(), &count, sizeof(count));
+	uint8_t* recordEnds = encoded.data() + sizeof(uint32_t);
+	uint8_t* payload = encoded.data() + headerSize;
+
+	size_t payloadSize = 0;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		payloadSize += EncodeDatasetRecord(block.m_Records[i], payload + payloadSize);
+		uint16_t end = static_cast<uint16_t>(payloadSize);
+		std::memcpy(recordEnds + i * sizeof(uint16_t), &end, sizeof(end));
+	}
+
+	encoded.resize(headerSize + payloadSize);
+}
+
+void DatasetWriter::AppendBlock(std::vector<uint8_t> const& encoded, uint32_t recordCount)
+{
+	std::lock_guard lock(m_ShardMutex);
+	if (!m_Error.empty())
+	{
+		return;
+	}
+
+	size_t footerSize = (m_ShardIndex.size() + 1) * sizeof(DatasetBlockIndex) + sizeof(DatasetFooter);
+	if (m_Shard.is_open() && !m_ShardIndex.empty()
+		&& m_ShardBytes + encoded.size() + footerSize > m_ShardSizeBytes)
+	{
+		FinishShard();
+		if (!m_Error.empty())
+		{
+			return;
+		}
+	}
+	if (!m_Shard.is_open() && !OpenShard())
+	{
+		return;
+	}
+
+	DatasetBlockIndex index{};
+	index.m_Offset = m_ShardBytes;
+	index.m_Size = static_cast<uint32_t>(encoded.size());
+	index.m_RecordCount = recordCount;
+	index.m_FirstRecord = m_ShardRecords;
+	m_ShardIndex.push_back(index);
+
+	m_Shard.write(reinterpret_cast<char const*>(encoded.data()), encoded.size());
+	if (!m_Shard.good())
+	{
+		SetError("write");
+		return;
+	}
+	m_ShardBytes += encoded.size();
+	m_ShardRecords += recordCount;
+	m_RecordsWritten += recordCount;
+}
+
+bool DatasetWriter::OpenShard()
+{
+	char suffix[16];
+	std::snprintf(suffix, sizeof(suffix), "-%05d", m_ShardCount.load());
+
+	m_ShardPath = m_PathPrefix + suffix + s_DatasetShardExtension;
+	m_Shard.open(m_ShardPath, std::ios::binary | std::ios::trunc);
+	if (!m_Shard.is_open())
+	{
+		SetError("open");
+		return false;
+	}
+	m_ShardBytes = 0;
+	m_ShardRecords = 0;
+	m_ShardIndex.clear();
+	m_ShardCount++;
+	return true;
+}
+
+void DatasetWriter::FinishShard()
+{
+	if (!m_Shard.is_open())
+	{
+		return;
+	}
+
+	DatasetFooter footer{};
+	footer.m_BlockCount = static_cast<uint32_t>(m_ShardIndex.size());
+	footer.m_RecordCount = m_ShardRecords;
+
+	m_Shard.write(reinterpret_cast<char const*>(m_ShardIndex.data()), m_ShardIndex.size() * sizeof(DatasetBlockIndex));
+	m_Shard.write(reinterpret_cast<char const*>(&footer), sizeof(footer));
+	bool bWritten = m_Shard.good();
+	m_Shard.close();
+	if (!bWritten)
+	{
+		SetError("write the index of");
+	}
+	else if (m_Shard.fail())
+	{
+		SetError("close");
+	}
+}
+
+void DatasetWriter::SetError(char const* what)
+{
+	if (m_Error.empty())
+	{
+		m_Error = std::string("Couldn't ") + what + " " + m_ShardPath;
+	}
+}
+
+}
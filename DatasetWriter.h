@@ -0,0 +1,122 @@
+#pragma once
+#ifndef BLOCKDROP_DATASET_WRITER_H
+#define BLOCKDROP_DATASET_WRITER_H
+
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Dataset.h"
+
+namespace BlockDrop
+{
+
+// Streams DatasetRecords from any number of simulation threads into shards
+// named <prefix>-00000.bds, <prefix>-00001.bds, ...
+//
+// Each simulation thread owns a Producer. A game's records are held by its
+// producer until EndGame() gives them the final score, then handed to the
+// writer a block at a time through a lock-free list, so neither call waits on
+// compression or disk. If the workers fall behind, the producers allocate
+// more blocks rather than stall.
+class DatasetWriter
+{
+public:
+	static constexpr size_t s_DefaultShardSizeBytes = 64 << 20;
+
+private:
+	struct Block;
+
+public:
+	class Producer
+	{
+	public:
+		explicit Producer(DatasetWriter& writer)
+			: m_Writer(writer)
+		{
+		}
+		Producer(Producer&) = delete;
+		~Producer()
+		{
+			Flush();
+		}
+
+		// Held until the game ends
+		void Add(DatasetRecord const& record);
+		// Sets m_FinalScore on every record added since the last EndGame() and
+		// queues them for writing
+		void EndGame(int finalScore);
+
+		// Hands over a partially filled block. Records of a game that hasn't
+		// ended stay held, and are dropped with the producer.
+		void Flush();
+
+	private:
+		void Push(DatasetRecord const& record);
+
+	private:
+		DatasetWriter& m_Writer;
+		Block* m_Block{};
+		// The game in progress
+		std::vector<DatasetRecord> m_Game;
+	};
+
+public:
+	DatasetWriter(std::string const& pathPrefix, size_t shardSizeBytes = s_DefaultShardSizeBytes, int workerCount = 1);
+	DatasetWriter(DatasetWriter&) = delete;
+	~DatasetWriter();
+
+	// Writes everything submitted so far and finishes the last shard. All
+	// producers must have been destroyed or flushed first. Returns false if
+	// a shard couldn't be opened, written or closed; see GetError().
+	bool Close();
+
+	// The first failure, empty if there wasn't one. Records after it are
+	// dropped, and not counted as written.
+	std::string const& GetError() const { return m_Error; }
+
+	uint64_t GetRecordsWritten() const { return m_RecordsWritten; }
+	int GetShardCount() const { return m_ShardCount; }
+
+private:
+	Block* AcquireBlock();
+	void ReleaseBlocks(Block* first, Block* last);
+	void Submit(Block* block);
+
+	void WorkerLoop();
+	void EncodeBlock(Block const& block, std::vector<uint8_t>& encoded) const;
+	void AppendBlock(std::vector<uint8_t> const& encoded, uint32_t recordCount);
+	bool OpenShard();
+	void FinishShard();
+	void SetError(char const* what);
+
+private:
+	std::string m_PathPrefix;
+	size_t m_ShardSizeBytes;
+
+	// Lock-free lists; both are only ever emptied whole, so there's no ABA.
+	std::atomic<Block*> m_Pending{};
+	std::atomic<Block*> m_Free{};
+	// Bumped on every submit so idle workers can atomic-wait on it
+	std::atomic<uint32_t> m_Signal{};
+	std::atomic<bool> m_bClosing{ false };
+	std::vector<std::thread> m_Workers;
+
+	// Shard state, only touched by workers under m_ShardMutex
+	std::mutex m_ShardMutex;
+	std::ofstream m_Shard;
+	std::string m_ShardPath;
+	std::string m_Error;
+	uint64_t m_ShardBytes{};
+	uint64_t m_ShardRecords{};
+	std::vector<DatasetBlockIndex> m_ShardIndex;
+	std::atomic<uint64_t> m_RecordsWritten{};
+	std::atomic<int> m_ShardCount{};
+};
+
+}
+
+#endif
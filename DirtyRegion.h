@@ -0,0 +1,123 @@
+#pragma once
+#ifndef BLOCKDROP_DIRTY_REGION_H
+#define BLOCKDROP_DIRTY_REGION_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+#include "olcPixelGameEngine.h"
+
+namespace BlockDrop
+{
+
+// Screen rectangles that need redrawing. Overlapping rectangles are merged,
+// and once s_MaxRects is reached new ones merge into whichever existing
+// rectangle grows least, so the list stays short and never allocates.
+class DirtyRegion
+{
+public:
+	static constexpr int s_MaxRects = 8;
+
+	struct Rect
+	{
+		olc::vi2d m_Pos{};
+		olc::vi2d m_Size{};
+
+		bool IsEmpty() const { return m_Size.x <= 0 || m_Size.y <= 0; }
+		int64_t GetArea() const { return IsEmpty() ? 0 : int64_t(m_Size.x) * m_Size.y; }
+
+		bool Intersects(Rect const& other) const
+		{
+			return m_Pos.x < other.m_Pos.x + other.m_Size.x && other.m_Pos.x < m_Pos.x + m_Size.x
+				&& m_Pos.y < other.m_Pos.y + other.m_Size.y && other.m_Pos.y < m_Pos.y + m_Size.y;
+		}
+
+		Rect Union(Rect const& other) const
+		{
+			olc::vi2d topLeft = m_Pos.min(other.m_Pos);
+			olc::vi2d bottomRight = (m_Pos + m_Size).max(other.m_Pos + other.m_Size);
+			return { topLeft, bottomRight - topLeft };
+		}
+	};
+
+public:
+	void Add(olc::vi2d pos, olc::vi2d size)
+	{
+		Add(Rect{ pos, size });
+	}
+
+	void Add(Rect rect)
+	{
+		if (rect.IsEmpty())
+		{
+			return;
+		}
+
+		// Absorb everything the new rectangle touches, repeating as it grows
+		for (int i = 0; i < m_Count;)
+		{
+			if (m_Rects[i].Intersects(rect))
+			{
+				rect = rect.Union(m_Rects[i]);
+				m_Rects[i] = m_Rects[--m_Count];
+				i = 0;
+			}
+			else
+			{
+				++i;
+			}
+		}
+
+		if (m_Count < s_MaxRects)
+		{
+			m_Rects[m_Count++] = rect;
+			return;
+		}
+
+		int best = 0;
+		int64_t bestGrowth = INT64_MAX;
+		for (int i = 0; i < m_Count; ++i)
+		{
+			int64_t growth = m_Rects[i].Union(rect).GetArea() - m_Rects[i].GetArea();
+			if (growth < bestGrowth)
+			{
+				best = i;
+				bestGrowth = growth;
+			}
+		}
+		rect = rect.Union(m_Rects[best]);
+		m_Rects[best] = m_Rects[--m_Count];
+		Add(rect);
+	}
+
+	bool Intersects(olc::vi2d pos, olc::vi2d size) const
+	{
+		Rect rect{ pos, size };
+		return std::any_of(begin(), end(), [&](Rect const& r) { return r.Intersects(rect); });
+	}
+
+	bool IsEmpty() const { return m_Count == 0; }
+	void Clear() { m_Count = 0; }
+
+	int64_t GetArea() const
+	{
+		int64_t area = 0;
+		for (Rect const& rect : *this)
+		{
+			area += rect.GetArea();
+		}
+		return area;
+	}
+
+	Rect const* begin() const { return m_Rects.data(); }
+	Rect const* end() const { return m_Rects.data() + m_Count; }
+
+private:
+	std::array<Rect, s_MaxRects> m_Rects{};
+	int m_Count{};
+};
+
+}
+
+#endif
@@ -1,5 +1,9 @@
 #include "olcPixelGameEngine.h"
 #include <stdint.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iterator>
 #include <string>
 #include <time.h>
 #include "Game.h"
@@ -9,12 +13,44 @@ namespace BlockDrop
 
 bool App::OnUserUpdate(float fElapsedTime)
 {
+	BLOCKDROP_PROFILE_ZONE("OnUserUpdate");
+
+	m_PerfHud.BeginFrame(fElapsedTime);
+	UpdateUi(fElapsedTime);
+	m_PerfHud.EndPhase(PerfPhase::Input);
+	UpdateSim(fElapsedTime);
+	m_PerfHud.EndPhase(PerfPhase::Sim);
+	Draw();
+
+	if (m_UiOverlayState == UiOverlayState::Perf)
+	{
+		m_PerfHud.SetSimStepTime(m_Snapshot->m_StepDuration);
+		m_PerfHud.Draw(*this, m_GlyphCache, m_BoardTopLeft + olc::vi2d{ 4, 4 });
+	}
+	m_PerfHud.EndPhase(PerfPhase::Hud);
+	m_PerfHud.CountDecals(*this);
+
+	return !m_bExiting;
+}
+
+void App::UpdateUi(float fElapsedTime)
+{
+	BLOCKDROP_PROFILE_ZONE("Input");
+
+#if defined(BLOCKDROP_PROFILE)
+	if (GetKey(olc::F9).bPressed)
+	{
+		Profiler::WriteChromeTrace(s_TraceFile);
+	}
+#endif
+
 	switch (m_UiOverlayState)
 	{
 	case UiOverlayState::Exit:
 	{
 		if (GetKey(olc::ENTER).bPressed)
 		{
+			SaveGameOnExit();
 			m_bExiting = true;
 		}
 		else if (GetKey(olc::ESCAPE).bPressed)
@@ -29,20 +65,26 @@ bool App::OnUserUpdate(float fElapsedTime)
 			m_UiOverlayState = UiOverlayState::None;
 		}
 	} break;
+	case UiOverlayState::Perf:
 	case UiOverlayState::None:
 	{
+		if (GetKey(olc::F3).bPressed)
+		{
+			m_UiOverlayState = m_UiOverlayState == UiOverlayState::Perf ? UiOverlayState::None : UiOverlayState::Perf;
+		}
+
 		switch (m_UiState)
 		{
 		case UiState::GameOver:
 		{
 			if (GetKey(olc::ENTER).bPressed)
 			{
-				if (m_Sim.GetScore() > m_ScoreBoard.GetLowestScore())
+				if (m_Snapshot->m_Score > m_ScoreBoard.GetLowestScore())
 				{
 					m_UiState = UiState::ScoreboardEntry;
 					m_UiIndex = 0;
 					m_PendingScoreboard = ScoreBoard(m_ScoreBoard.GetScoreList());
-					m_PendingScoreboard.SetScore("???", m_Sim.GetScore(), m_Sim.GetLevel());
+					m_PendingScoreboard.SetScore("???", m_Snapshot->m_Score, m_Snapshot->m_Level);
 					auto const& scoreList = m_PendingScoreboard.GetScoreList();
 					m_PendingScoreIndex = static_cast<int>(std::distance(scoreList.begin(),
 						std::find_if(scoreList.begin(), scoreList.end(), [](auto const& e) {
@@ -53,7 +95,7 @@ bool App::OnUserUpdate(float fElapsedTime)
 				else
 				{
 					m_UiState = UiState::Game;
-					m_Sim.ResetGame();
+					ResetGame();
 				}
 			}
 		} [[fallthrough]];
@@ -111,30 +153,82 @@ bool App::OnUserUpdate(float fElapsedTime)
 			{
 				m_ScoreBoard.SetScore(
 					m_PendingName,
-					m_Sim.GetScore(),
-					m_Sim.GetLevel());
+					m_Snapshot->m_Score,
+					m_Snapshot->m_Level);
 				m_UiState = UiState::Game;
-				m_Sim.ResetGame();
+				ResetGame();
 			}
 		} break;
 		}
 	} break;
 	}
+}
+
+void App::UpdateSim(float fElapsedTime)
+{
+	BLOCKDROP_PROFILE_ZONE("UpdateSim");
+
+	bool bPlaying = IsPlaying();
+	m_SimThread.SetRunning(bPlaying);
+	if (!m_bSimThread)
+	{
+		m_SimThread.Advance(fElapsedTime);
+	}
 
-	if (m_UiOverlayState == UiOverlayState::None && m_UiState == UiState::Game)
+	m_Snapshot = &m_SimThread.GetSnapshot();
+	if (bPlaying && m_Snapshot->m_bGameOver && m_Snapshot->m_GameIndex == m_GameIndex)
 	{
-		auto input = GetInput();
-		m_Sim.Update(fElapsedTime, input);
-		if (m_Sim.IsGameOver())
-		{
-			m_UiState = UiState::GameOver;
-		}
+		m_UiState = UiState::GameOver;
 	}
+}
 
-	Draw();
+olc::vi2d App::GetFallingBlockOffset() const
+{
+	// Only a single row of gravity is eased in. Moves, rotations and drops
+	// show as soon as they're simulated.
+	auto const& current = m_Snapshot->m_FallingBlock;
+	auto const& previous = m_Snapshot->m_PreviousFallingBlock;
+	if (!current.has_value() || !previous.has_value()
+		|| current->GetTileColor() != previous->GetTileColor()
+		|| current->GetRotationIndex() != previous->GetRotationIndex()
+		|| current->GetPosition() - previous->GetPosition() != olc::vi2d{ 0, 1 })
+	{
+		return {};
+	}
 
-	return !m_bExiting;
+	double alpha = std::clamp((m_SimThread.GetTime() - m_Snapshot->m_StepTime) / SimThread::s_StepSec, 0.0, 1.0);
+	return { 0, static_cast<int>(std::round((alpha - 1.0f) * s_TileSizePx)) };
+}
+
+void App::SaveGameOnExit()
+{
+	if (!m_bUseSaveFile)
+	{
+		return;
+	}
+
+	// The Sim is ours again once its thread has stopped
+	m_SimThread.Stop();
+	if (m_UiState == UiState::Game && !m_Sim.IsGameOver())
+	{
+		SaveSimToFile(m_Sim, s_SaveFile);
+	}
+	else
+	{
+		// Nothing worth resuming; don't bring back an older game either
+		std::remove(s_SaveFile);
+	}
+}
+
+void App::RestoreSavedGame()
+{
+	if (LoadSimFromFile(m_Sim, s_SaveFile))
+	{
+		// Saves are single-use, so a crash later doesn't resume a stale game
+		std::remove(s_SaveFile);
+	}
 }
+
 void App::RotateScoreboardCharacter(int direction)
 {
 	if (m_UiIndex < 0 || m_UiIndex >= m_PendingName.size())
@@ -148,21 +242,43 @@ void App::RotateScoreboardCharacter(int direction)
 
 void App::Draw()
 {
-	Clear(olc::VERY_DARK_GREY);
+	BLOCKDROP_PROFILE_ZONE("Draw");
+
+	UpdateDirtyRegion();
+
+	// Layer 0 holds only what changes; the static UI layer shows through.
+	// It keeps last frame's pixels, so only dirty rectangles are cleared
+	// and redrawn.
+	for (auto const& rect : m_DirtyRegion)
+	{
+		FillRect(rect.m_Pos, rect.m_Size, olc::BLANK);
+	}
+	m_PixelsTouched = m_DirtyRegion.GetArea();
 
 	DrawUI();
+	m_PerfHud.EndPhase(PerfPhase::Ui);
 
+	bool bBoardDirty = m_DirtyRegion.Intersects(m_BoardTopLeft, { s_BoardTileWidthPx, s_BoardTileHeightPx });
 	if (m_UiOverlayState == UiOverlayState::About)
 	{
-		DrawAbout();
+		if (bBoardDirty)
+		{
+			DrawAbout();
+		}
 	}
 	else if (m_UiOverlayState == UiOverlayState::Exit)
 	{
-		DrawExit();
+		if (bBoardDirty)
+		{
+			DrawExit();
+		}
 	}
 	else if (m_UiState == UiState::ScoreboardEntry)
 	{
-		DrawScoreboard();
+		if (bBoardDirty)
+		{
+			DrawScoreboard();
+		}
 	}
 	else
 	{
@@ -172,11 +288,65 @@ void App::Draw()
 			DrawGameOver();
 		}
 	}
+	m_PerfHud.EndPhase(PerfPhase::Tiles);
+
+	// Re-uploaded only if something was redrawn
+	SetDrawTarget(uint8_t{ 0 }, !m_DirtyRegion.IsEmpty());
+}
+
+void App::UpdateDirtyRegion()
+{
+	m_DirtyRegion.Clear();
+
+	if (m_Snapshot->m_BoardVersion != m_BoardMeshVersion)
+	{
+		m_BoardMesh.m_bDirty = true;
+		m_BoardMeshVersion = m_Snapshot->m_BoardVersion;
+	}
+
+	DrawnUi& drawn = m_DrawnUi;
+	if (!drawn.m_bValid)
+	{
+		// Layer 0 starts out opaque
+		m_DirtyRegion.Add({ 0, 0 }, { ScreenWidthPx, s_ScreenHeightPx });
+	}
+
+	// Overlays and the scoreboard cover the board area
+	bool bBoardArea = !drawn.m_bValid
+		|| drawn.m_UiState != m_UiState
+		|| drawn.m_UiOverlayState != m_UiOverlayState
+		|| (m_UiState == UiState::ScoreboardEntry
+			&& (drawn.m_UiIndex != m_UiIndex || drawn.m_PendingName != m_PendingName));
+	if (bBoardArea)
+	{
+		m_DirtyRegion.Add(m_BoardTopLeft, { s_BoardTileWidthPx, s_BoardTileHeightPx });
+	}
+
+	olc::vi2d valueSize{ s_SidebarValueWidth, s_SidebarValueHeight };
+	if (!drawn.m_bValid || drawn.m_Level != m_Snapshot->m_Level)
+	{
+		m_DirtyRegion.Add({ s_SidebarNumbersLeft, s_SidebarLevelTop }, valueSize);
+	}
+	if (!drawn.m_bValid || drawn.m_Score != m_Snapshot->m_Score)
+	{
+		m_DirtyRegion.Add({ s_SidebarNumbersLeft, s_SidebarScoreTop }, valueSize);
+	}
+
+	drawn.m_bValid = true;
+	drawn.m_UiState = m_UiState;
+	drawn.m_UiOverlayState = m_UiOverlayState;
+	drawn.m_Level = m_Snapshot->m_Level;
+	drawn.m_Score = m_Snapshot->m_Score;
+	drawn.m_UiIndex = m_UiIndex;
+	if (drawn.m_PendingName != m_PendingName)
+	{
+		drawn.m_PendingName = m_PendingName;
+	}
 }
 
 void App::DrawScoreboard()
 {
-	DrawString(s_BoardLeft + 60, s_UiTop + 15, "SCORES", olc::WHITE, 3);
+	DrawStaticString({ s_BoardLeft + 60, s_UiTop + 15 }, "SCORES", olc::WHITE, 3);
 
 	static constexpr int s_ScoresTop = s_UiTop + 75;
 	static constexpr int s_NameLeft = s_BoardLeft + 45;
@@ -195,13 +365,14 @@ void App::DrawScoreboard()
 		olc::Pixel color = (isCurrent) ? olc::YELLOW : olc::WHITE;
 
 		int rowTop = s_ScoresTop + (i * s_ScoreLineHeight);
-		DrawString(	
+		DrawCachedString(
 			{ s_NameLeft, rowTop }, std::get<0>(*iter), color, 2);
-		std::string points = std::to_string(std::get<1>(*iter));
+		char points[16];
+		int pointsLength = std::snprintf(points, sizeof(points), "%d", std::get<1>(*iter));
 		int scoreLeft = s_ScoreLeft + (s_ScoreCharWidth * (
-			s_ScoreNumberDigits - static_cast<int>(points.size())));
-		DrawString(
-			{ scoreLeft, rowTop }, points, color, 2);
+			s_ScoreNumberDigits - pointsLength));
+		DrawCachedString(
+			{ scoreLeft, rowTop }, { points, static_cast<size_t>(pointsLength) }, color, 2);
 
 		if (isCurrent)
 		{
@@ -215,7 +386,7 @@ void App::DrawScoreboard()
 void App::DrawGameOver()
 {
 	olc::vi2d pos{ s_BoardLeft + 20, s_UiTop + (s_BoardTileHeightPx / 2) - 40};
-	DrawStringDecal(pos, "GAME OVER\n  Press\n [Enter]", olc::WHITE, { 3, 3 });
+	DrawStringDecal(pos, m_GameOverText, olc::WHITE, { 3, 3 });
 }
 
 void App::DrawAbout()
@@ -223,13 +394,13 @@ void App::DrawAbout()
 	using namespace olc;
 	
 	static constexpr int s_AboutTop{ s_UiTop + 100 };
-	DrawString(s_BoardLeft + 50, s_AboutTop, "Block Drop", olc::WHITE, 2);
-	DrawString(s_BoardLeft + 60, s_AboutTop + 25, "By Owen Raccuglia", olc::WHITE, 1);
-	DrawString(s_BoardLeft + 55, s_AboutTop + 35, "and Paul Raccuglia", olc::WHITE, 1);
+	DrawStaticString({ s_BoardLeft + 50, s_AboutTop }, "Block Drop", olc::WHITE, 2);
+	DrawStaticString({ s_BoardLeft + 60, s_AboutTop + 25 }, "By Owen Raccuglia", olc::WHITE, 1);
+	DrawStaticString({ s_BoardLeft + 55, s_AboutTop + 35 }, "and Paul Raccuglia", olc::WHITE, 1);
 
-	DrawString(s_BoardLeft + 7, s_AboutTop + 150, "olcPixelGameEngine is Copyright\n 2018 - 2024 OneLoneCoder.com", olc::WHITE, 1);
+	DrawStaticString({ s_BoardLeft + 7, s_AboutTop + 150 }, "olcPixelGameEngine is Copyright\n 2018 - 2024 OneLoneCoder.com", olc::WHITE, 1);
 
-	DrawString(s_BoardLeft + 6, s_AboutTop + 285, "tile.png is MIT License,\ngithub.com/andrew-wilkes/tetron", olc::WHITE, 1);
+	DrawStaticString({ s_BoardLeft + 6, s_AboutTop + 285 }, "tile.png is MIT License,\ngithub.com/andrew-wilkes/tetron", olc::WHITE, 1);
 }
 
 void App::DrawExit()
@@ -237,70 +408,39 @@ void App::DrawExit()
 	using namespace olc;
 
 	static constexpr int s_ExitTop{ s_UiTop + 200 };
-	DrawString(s_BoardLeft + 60, s_ExitTop, "Exit?", olc::WHITE, 4);
+	DrawStaticString({ s_BoardLeft + 60, s_ExitTop }, "Exit?", olc::WHITE, 4);
 
-	DrawString(s_BoardLeft + 45, s_ExitTop + 65, "Press ENTER", olc::WHITE, 2);
-	DrawString(s_BoardLeft + 77, s_ExitTop + 90, "to exit", olc::WHITE, 2);
+	DrawStaticString({ s_BoardLeft + 45, s_ExitTop + 65 }, "Press ENTER", olc::WHITE, 2);
+	DrawStaticString({ s_BoardLeft + 77, s_ExitTop + 90 }, "to exit", olc::WHITE, 2);
 }
 
 
-void App::DrawUI()
+void App::DrawStaticUI()
 {
 	using namespace olc;
 
+	Clear(olc::VERY_DARK_GREY);
+
 	vi2d size{ s_BoardTileWidthPx, s_BoardTileHeightPx };
-	vi2d topRight{ m_BoardTopLeft.x + s_BoardTileWidthPx, m_BoardTopLeft.y };
-	vi2d bottomRight{ m_BoardTopLeft + size };
-
-	// Sidebar constants
-	static constexpr int s_SidebarWidth{ 110 };
-	static constexpr int s_SidebarPreviewHeight{ 100 };
-	static constexpr int s_SidebarNumbersTop{ s_UiTop + s_SidebarPreviewHeight + 25 };
-	static constexpr int s_SidebarNumbersTextTop{ s_SidebarNumbersTop + 8 };
-	static constexpr int s_SidebarNumbersLineHeight{ 24 };
-	static constexpr int s_SidebarNumbersHeight{ 102 };
-	static constexpr int s_SidebarLeft{ s_BoardRight + 25 };
-	static constexpr int s_SidebarRight{ s_SidebarLeft + s_SidebarWidth };
-	static constexpr int s_SidebarNumbersLeft{ s_SidebarLeft + 10 };
-	static constexpr int s_SidebarInstructionsHelpTop = s_SidebarNumbersTop + s_SidebarNumbersHeight + 25;
-	static constexpr int s_SidebarInstructionsHelpHeight = 268;
-	static constexpr int s_SidebarHelpStrTop = s_SidebarInstructionsHelpTop + 7;
-	static constexpr int s_SidebarHelpLeft = 337;
 
 	// Sidebar: Preview
 	DrawBorder({ s_SidebarLeft, s_UiTop }, { s_SidebarWidth, s_SidebarPreviewHeight }, 3, olc::GREY);
 	FillRect({ s_SidebarLeft, s_UiTop }, { s_SidebarWidth, s_SidebarPreviewHeight }, olc::BLACK);
-	// Preview Tile
-	auto* tetronimo = TetronimoFactory::GetTetronimoByColor(m_Sim.GetNextBlockColor());
-	if (tetronimo != nullptr)
-	{
-		olc::vi2d origin{
-			s_SidebarLeft + (s_SidebarWidth / 2),
-			s_UiTop + (s_SidebarPreviewHeight / 2) - s_TileSizePx,
-		};
-		origin += tetronimo->m_CenterOffset * s_TileSizePx;
-
-		DrawTetronimoSquares(origin, tetronimo->m_Color, tetronimo->m_RotatedTileOffsets[0]);
-	}
 
 	// Sidebar: Level and Score
 	DrawBorder({ s_SidebarLeft, s_SidebarNumbersTop }, { s_SidebarWidth, s_SidebarNumbersHeight }, 3, olc::GREY);
 	FillRect({ s_SidebarLeft, s_SidebarNumbersTop }, { s_SidebarWidth, s_SidebarNumbersHeight }, olc::BLACK);
 
-	DrawString(s_SidebarNumbersLeft, s_SidebarNumbersTextTop,
+	DrawStaticString({ s_SidebarNumbersLeft, s_SidebarNumbersTextTop },
 		"Level:", olc::WHITE, 2);
-	DrawString(s_SidebarNumbersLeft, s_SidebarNumbersTextTop + s_SidebarNumbersLineHeight,
-		std::to_string(m_Sim.GetLevel()), olc::WHITE, 2);
-	DrawString(s_SidebarNumbersLeft, s_SidebarNumbersTextTop + 2 * s_SidebarNumbersLineHeight,
+	DrawStaticString({ s_SidebarNumbersLeft, s_SidebarNumbersTextTop + 2 * s_SidebarNumbersLineHeight },
 		"Score:", olc::WHITE, 2);
-	DrawString(s_SidebarNumbersLeft, s_SidebarNumbersTextTop + 3 * s_SidebarNumbersLineHeight,
-		std::to_string(m_Sim.GetScore()), olc::WHITE, 2);
 
 	// Sidebar: Instructions
 	DrawBorder({ s_SidebarLeft, s_SidebarInstructionsHelpTop }, { s_SidebarWidth, s_SidebarInstructionsHelpHeight }, 3, olc::GREY);
 	FillRect({ s_SidebarLeft, s_SidebarInstructionsHelpTop }, { s_SidebarWidth, s_SidebarInstructionsHelpHeight }, olc::BLACK);
 
-	std::vector<std::string> helpLines{
+	static constexpr char const* s_HelpLines[]{
 		"[Up]",
 		"Rotate",
 		"",
@@ -313,16 +453,16 @@ void App::DrawUI()
 		"[?]",
 		"About",
 	};
-	for (int i = 0; i < helpLines.size(); ++i)
+	for (int i = 0; i < std::ssize(s_HelpLines); ++i)
 	{
 		int x = s_SidebarHelpLeft;
 		if (i % 3 == 1)
 		{
 			x += 10;
 		}
-		DrawString(
-			x, s_SidebarHelpStrTop + (i * s_SidebarNumbersLineHeight),
-			helpLines[i], olc::WHITE, 2);
+		DrawStaticString(
+			{ x, s_SidebarHelpStrTop + (i * s_SidebarNumbersLineHeight) },
+			s_HelpLines[i], olc::WHITE, 2);
 	}
 
 	// Board
@@ -330,6 +470,40 @@ void App::DrawUI()
 	FillRect(m_BoardTopLeft, size, olc::BLACK);
 }
 
+void App::DrawUI()
+{
+	BLOCKDROP_PROFILE_ZONE("DrawUI");
+
+	// Sidebar: Preview
+	auto* tetronimo = TetronimoFactory::GetTetronimoByColor(m_Snapshot->m_NextBlockColor);
+	if (tetronimo != nullptr)
+	{
+		olc::vi2d origin{
+			s_SidebarLeft + (s_SidebarWidth / 2),
+			s_UiTop + (s_SidebarPreviewHeight / 2) - s_TileSizePx,
+		};
+		origin += tetronimo->m_CenterOffset * s_TileSizePx;
+
+		DrawTetronimoSquares(origin, tetronimo->m_Color, tetronimo->m_RotatedTileOffsets[0]);
+	}
+
+	// Sidebar: Level and Score, formatted on the stack
+	olc::vi2d valueSize{ s_SidebarValueWidth, s_SidebarValueHeight };
+	char value[16];
+	if (m_DirtyRegion.Intersects({ s_SidebarNumbersLeft, s_SidebarLevelTop }, valueSize))
+	{
+		int length = std::snprintf(value, sizeof(value), "%d", m_Snapshot->m_Level);
+		DrawCachedString({ s_SidebarNumbersLeft, s_SidebarLevelTop },
+			{ value, static_cast<size_t>(length) }, olc::WHITE, 2);
+	}
+	if (m_DirtyRegion.Intersects({ s_SidebarNumbersLeft, s_SidebarScoreTop }, valueSize))
+	{
+		int length = std::snprintf(value, sizeof(value), "%d", m_Snapshot->m_Score);
+		DrawCachedString({ s_SidebarNumbersLeft, s_SidebarScoreTop },
+			{ value, static_cast<size_t>(length) }, olc::WHITE, 2);
+	}
+}
+
 void App::DrawBorder(olc::vi2d const& topLeft, olc::vi2d size, int borderWidth, olc::Pixel color)
 {
 	size -= olc::vi2d{ 1, 1 };
@@ -340,78 +514,32 @@ void App::DrawBorder(olc::vi2d const& topLeft, olc::vi2d size, int borderWidth,
 	}
 }
 
-olc::Pixel App::GetColor(TileColor color)
+void App::DrawTiles()
 {
-	switch (color)
-	{
-	case TileColor::Red:
-		return olc::RED;
-	case TileColor::Blue:
-		return olc::BLUE;
-	case TileColor::Cyan:
-		return olc::CYAN;
-	case TileColor::Magenta:
-		return olc::MAGENTA;
-	case TileColor::Yellow:
-		return olc::YELLOW;
-	case TileColor::Green:
-		return olc::GREEN;
-	case TileColor::Orange:
-		return olc::Pixel(0xec, 0x97, 0x06);
-	default:
-		assert(0);
-		return olc::BLACK;
-	}
+	BLOCKDROP_PROFILE_ZONE("DrawTiles");
+
+	// Drop preview, board tiles and falling block, as a single decal
+	UpdateBoardMesh();
+	m_BoardMesh.Draw(*this, m_TileAtlas);
 }
 
-void App::DrawTiles()
+void App::UpdateBoardMesh()
 {
-	using namespace olc;
-
-	// Board tiles
-	using namespace olc;
-	for (int row = 0; row < s_BoardTileHeight; ++row)
+	BoardMesh& mesh = m_BoardMesh;
+	olc::vi2d fallOffset = GetFallingBlockOffset();
+	if (!mesh.m_bDirty && fallOffset == m_BoardMeshFallOffset)
 	{
-		for (int col = 0; col < s_BoardTileWidth; ++col)
-		{
-			const auto tile = m_Sim.At(row, col);
-			if (tile == TileColor::None)
-			{
-				continue;
-			}
-
-			DrawDecal(BoardToScreen(row, col), m_TileDecal.get(), {1, 1}, GetColor(tile));
-		}
+		return;
 	}
 
-	// Falling block
-	auto optFallingBlock = m_Sim.GetFallingBlock();
-	if (optFallingBlock.has_value())
-	{
-		auto& tetronimo = optFallingBlock.value();
-		auto position = tetronimo.GetPosition();
-		DrawTetronimo(tetronimo, BoardToScreen(position));
-
-		// Drop preview
-		auto color = GetColor(tetronimo.GetTileColor());
-		position = m_Sim.GetDropPosition();
-		for (auto& square : tetronimo.GetSquares())
-		{
-			int row = position.y + square.m_Row;
-			int col = position.x + square.m_Column;
-
-			if (row < 0 || row > s_BoardTileHeight || col < 0 || col > s_BoardTileWidth)
-			{
-				continue;
-			}
-			DrawTileOutline(row, col, square.m_Directions, color);
-		}
-	}
+	mesh.m_bDirty = false;
+	mesh.Clear();
+	mesh.AddBoard(*m_Snapshot, m_BoardTopLeft, m_TileAtlas, fallOffset);
+	m_BoardMeshFallOffset = fallOffset;
 }
 
 void App::DrawTetronimoSquares(olc::vi2d origin, TileColor tileColor, std::vector<TetronimoSquare> const& squares)
 {
-	auto color = GetColor(tileColor);
 	for (auto& square : squares)
 	{
 		olc::vi2d pos = origin + olc::vi2d{ square.m_Column * s_TileSizePx, square.m_Row * s_TileSizePx };
@@ -419,60 +547,38 @@ void App::DrawTetronimoSquares(olc::vi2d origin, TileColor tileColor, std::vecto
 		{
 			continue;
 		}
-		DrawTileAtPixel(pos, color);
+		DrawTileAtPixel(pos, tileColor);
 	}
 }
 
-void App::DrawTile(int row, int col, olc::Pixel color)
+void App::OnFramePresented()
 {
-	if (row < 0 || row > s_BoardTileHeight || col < 0 || col > s_BoardTileWidth)
+	m_PerfHud.EndFrame();
+
+	// On the clock the presses were stamped with
+	double now = m_SimThread.GetTime();
+	InputEvent event{};
+	while (m_SimThread.TakeShownInput(*m_Snapshot, event))
 	{
-		return;
+		m_InputLatency.Add(now - event.m_Time);
 	}
-	DrawTileAtPixel(BoardToScreen(row, col), color);
 }
 
-void App::DrawTileOutline(int row, int col, BorderDirection directions, olc::Pixel color)
+void App::OnKeyStateChanged(olc::Key key, bool bDown)
 {
-	if (row < 0 || row > s_BoardTileHeight || col < 0 || col > s_BoardTileWidth)
-	{
-		return;
-	}
-
-	olc::vi2d topLeft = BoardToScreen(row, col);
-	olc::vi2d bottomRight{ topLeft.x + s_TileSizePx - 1, topLeft.y + s_TileSizePx - 1 };
-
-	if (HasDirection(directions, BorderDirection::Top))
+	InputAction action{};
+	switch (key)
 	{
-		DrawLine(topLeft.x, topLeft.y, bottomRight.x, topLeft.y, color); // top
+	case olc::Key::LEFT: action = InputAction::Left; break;
+	case olc::Key::RIGHT: action = InputAction::Right; break;
+	case olc::Key::DOWN: action = InputAction::SoftDrop; break;
+	case olc::Key::SPACE: action = InputAction::HardDrop; break;
+	case olc::Key::Q: action = InputAction::RotateLeft; break;
+	case olc::Key::E:
+	case olc::Key::UP: action = InputAction::RotateRight; break;
+	default: return;
 	}
-	if (HasDirection(directions, BorderDirection::Right))
-	{
-		DrawLine(bottomRight.x, topLeft.y, bottomRight.x, bottomRight.y, color); // right
-	}
-	if (HasDirection(directions, BorderDirection::Bottom))
-	{
-		DrawLine(topLeft.x, bottomRight.y, bottomRight.x, bottomRight.y, color); // bottom
-	}
-	if (HasDirection(directions, BorderDirection::Left))
-	{
-		DrawLine(topLeft.x, topLeft.y, topLeft.x, bottomRight.y, color); // left
-	}
-}
-
-Input App::GetInput()
-{
-	Input result = {};
-	result.bLeft = GetKey(olc::Key::LEFT).bPressed;
-	result.bLeftHeld = GetKey(olc::Key::LEFT).bHeld;
-	result.bRight = GetKey(olc::Key::RIGHT).bPressed;
-	result.bRightHeld = GetKey(olc::Key::RIGHT).bHeld;
-	result.bRotateLeft = GetKey(olc::Key::Q).bPressed;
-	result.bRotateRight = GetKey(olc::Key::E).bPressed || GetKey(olc::Key::UP).bPressed;
-	result.bSoftDrop = GetKey(olc::Key::DOWN).bHeld;
-	result.bHardDrop = GetKey(olc::Key::SPACE).bPressed;
-
-	return result;
+	m_SimThread.PushInput(action, bDown);
 }
 
 }
@@ -4,8 +4,16 @@
 
 #include "olcPixelGameEngine.h"
 
+#include "DirtyRegion.h"
+#include "GlyphCache.h"
+#include "LatencyHistogram.h"
+#include "PerfHud.h"
+#include "Profiler.h"
 #include "ScoreBoard.h"
 #include "Sim.h"
+#include "SimState.h"
+#include "SimThread.h"
+#include "TileAtlas.h"
 
 namespace BlockDrop
 {
@@ -21,6 +29,20 @@ enum class UiOverlayState
 	None,
 	About,
 	Exit,
+	// Frame timings over the game, which carries on underneath
+	Perf,
+};
+
+// What layer 0 showed when it was last drawn, to work out what to redraw
+struct DrawnUi
+{
+	bool m_bValid{ false };
+	UiState m_UiState{};
+	UiOverlayState m_UiOverlayState{};
+	int m_Level{};
+	int m_Score{};
+	int m_UiIndex{};
+	std::string m_PendingName{};
 };
 
 class App : public olc::PixelGameEngine
@@ -42,57 +64,185 @@ public:
 	static constexpr int s_BoardLeft{ 25 };
 	static constexpr int s_BoardRight{ s_BoardLeft + s_BoardTileWidthPx + 25 };
 
+	// Sidebar
+	static constexpr int s_SidebarWidth{ 110 };
+	static constexpr int s_SidebarPreviewHeight{ 100 };
+	static constexpr int s_SidebarNumbersTop{ s_UiTop + s_SidebarPreviewHeight + 25 };
+	static constexpr int s_SidebarNumbersTextTop{ s_SidebarNumbersTop + 8 };
+	static constexpr int s_SidebarNumbersLineHeight{ 24 };
+	static constexpr int s_SidebarNumbersHeight{ 102 };
+	static constexpr int s_SidebarLeft{ s_BoardRight + 25 };
+	static constexpr int s_SidebarRight{ s_SidebarLeft + s_SidebarWidth };
+	static constexpr int s_SidebarNumbersLeft{ s_SidebarLeft + 10 };
+	static constexpr int s_SidebarLevelTop{ s_SidebarNumbersTextTop + s_SidebarNumbersLineHeight };
+	static constexpr int s_SidebarScoreTop{ s_SidebarNumbersTextTop + 3 * s_SidebarNumbersLineHeight };
+	// Room for a level or score value at scale 2
+	static constexpr int s_SidebarValueWidth{ ScreenWidthPx - s_SidebarNumbersLeft };
+	static constexpr int s_SidebarValueHeight{ 16 };
+	static constexpr int s_SidebarInstructionsHelpTop = s_SidebarNumbersTop + s_SidebarNumbersHeight + 25;
+	static constexpr int s_SidebarInstructionsHelpHeight = 268;
+	static constexpr int s_SidebarHelpStrTop = s_SidebarInstructionsHelpTop + 7;
+	static constexpr int s_SidebarHelpLeft = 337;
+
+	// Game in progress when the player exits, restored on the next launch
+	static constexpr char s_SaveFile[] = "savegame.bin";
+	// Written on F9 in builds with BLOCKDROP_PROFILE; see Profiler.h
+	static constexpr char s_TraceFile[] = "trace.json";
+	// Quads pooled on layer 0 up front; more than any screen draws, such as
+	// the game over text's one per character
+	static constexpr uint32_t s_ReservedDecals = 64;
+
 public:
 	App()
 		: m_Sim(s_BoardTileWidth, s_BoardTileHeight)
 	{
 		srand(static_cast<uint32_t>(time(nullptr)));
 		sAppName = "BlockDrop";
+
+		RestoreSavedGame();
+	}
+
+	// Fixed seed and no save or score files, for replays and headless tools,
+	// so every run starts from the same state. By default the Sim steps on
+	// the engine thread with each frame's elapsed time, so a replay plays the
+	// same way every time; bSimThread steps it in real time as the game does.
+	explicit App(uint32_t seed, bool bSimThread = false)
+		: m_bUseSaveFile(false)
+		, m_bSimThread(bSimThread)
+		, m_Sim(s_BoardTileWidth, s_BoardTileHeight, seed)
+		, m_ScoreBoard(false)
+	{
+		sAppName = "BlockDrop";
 	}
 
 	bool OnUserCreate() override
 	{
-		m_TileSprite = std::make_unique<olc::Sprite>("tile.png");
-		m_TileDecal = std::make_unique<olc::Decal>(m_TileSprite.get());
+		olc::Sprite tile("tile.png");
+		m_TileAtlas.Build(*this, tile, s_TileSizePx);
+		m_PerfHud.Create();
+		// The scales App draws text at
+		m_GlyphCache.BuildGlyphs(*this, 1);
+		m_GlyphCache.BuildGlyphs(*this, 2);
+
+		// Behind layer 0, which is cleared to transparent each frame
+		m_StaticUiLayer = static_cast<uint8_t>(CreateLayer());
+		SetDrawTarget(m_StaticUiLayer);
+		DrawStaticUI();
+		EnableLayer(m_StaticUiLayer, true);
+		SetDrawTarget(nullptr);
+
+		// Decals are pooled per layer; sized up front so neither a filling
+		// board nor the first visit to a screen allocates. The board mesh is
+		// every tile, plus the drop preview and falling block, in one decal.
+		int boardMeshTiles = s_BoardTileWidth * s_BoardTileHeight + 8;
+		m_BoardMesh.Reserve(boardMeshTiles);
+		ReserveDecals(1, 6 * boardMeshTiles);
+		ReserveDecals(s_ReservedDecals);
+
+		BLOCKDROP_PROFILE_THREAD("Engine");
+		m_SimThread.Start(m_bSimThread);
+		m_Snapshot = &m_SimThread.GetSnapshot();
 
 		return true;
 	}
 
 	bool OnUserUpdate(float fElapsedTime) override;
+	// Sends game keys to the Sim thread as they happen
+	void OnKeyStateChanged(olc::Key key, bool bDown) override;
+	// Measures the presses the frame shows the effect of
+	void OnFramePresented() override;
+
+	// Steps only during play; overlays other than the perf HUD, and the end
+	// of game screens, pause it
+	bool IsPlaying() const
+	{
+		return (m_UiOverlayState == UiOverlayState::None || m_UiOverlayState == UiOverlayState::Perf)
+			&& m_UiState == UiState::Game;
+	}
+	UiState GetUiState() const { return m_UiState; }
+	// Layer 0 pixels cleared and redrawn by the last frame
+	int64_t GetPixelsTouched() const { return m_PixelsTouched; }
+	// From a key press to the first frame presented after it's stepped
+	LatencyHistogram const& GetInputLatency() const { return m_InputLatency; }
 
 private:
-	std::unique_ptr<olc::Sprite> m_TileSprite{};
-	std::unique_ptr<olc::Decal> m_TileDecal{};
+	TileAtlas m_TileAtlas{};
+	// Backgrounds, borders and labels that never change; drawn once
+	uint8_t m_StaticUiLayer{};
+	GlyphCache m_GlyphCache{};
 
 	olc::vi2d m_BoardTopLeft{ s_BoardLeft, s_UiTop };
 
 	UiState m_UiState{ UiState::Game };
 	UiOverlayState m_UiOverlayState{ UiOverlayState::None };
 	bool m_bExiting{ false };
+	bool m_bUseSaveFile{ true };
+	bool m_bSimThread{ true };
 	int m_UiIndex{ 0 };
 	float m_UiRepeatDelay{ -1.0f };
 	std::string m_PendingName{ "AAA" };
+	// Too long for the small string buffer, so made once rather than per frame
+	std::string const m_GameOverText{ "GAME OVER\n  Press\n [Enter]" };
 	ScoreBoard m_PendingScoreboard{};
 	int m_PendingScoreIndex{};
 
+	// Only used directly before m_SimThread starts and after it stops;
+	// otherwise read through the snapshot
 	Sim m_Sim;
 	FileBackedScoreBoard m_ScoreBoard{};
 
+	SimThread m_SimThread{ m_Sim };
+	// Latest from m_SimThread, taken once per frame
+	SimSnapshot const* m_Snapshot{};
+	// Game the UI is showing; a snapshot from before a reset is still over
+	uint32_t m_GameIndex{};
+	LatencyHistogram m_InputLatency{};
+	PerfHud m_PerfHud{};
+
+	BoardMesh m_BoardMesh{};
+	// What the mesh was built from
+	uint64_t m_BoardMeshVersion{};
+	olc::vi2d m_BoardMeshFallOffset{};
+
+	// Layer 0 is only cleared, redrawn and uploaded inside these
+	DirtyRegion m_DirtyRegion{};
+	DrawnUi m_DrawnUi{};
+	int64_t m_PixelsTouched{};
+
 private:
+	// Keys for the overlays and end of game screens
+	void UpdateUi(float fElapsedTime);
+	void UpdateSim(float fElapsedTime);
+	void ResetGame() { m_GameIndex = m_SimThread.RequestReset(); }
+	olc::vi2d GetFallingBlockOffset() const;
+
 	void Draw();
+	void UpdateDirtyRegion();
 
 	void DrawAbout();
 	void DrawExit();
 	void DrawGameOver();
 	void DrawScoreboard();
 
+	void DrawStaticUI();
 	void DrawUI();
 
+	// DrawString through the glyph cache; static text also keeps its spans
+	void DrawCachedString(olc::vi2d pos, std::string_view text, olc::Pixel color, uint32_t scale)
+	{
+		m_GlyphCache.DrawString(*this, pos, text, color, scale);
+	}
+	void DrawStaticString(olc::vi2d pos, std::string_view text, olc::Pixel color, uint32_t scale)
+	{
+		m_GlyphCache.DrawStaticString(*this, pos, text, color, scale);
+	}
+
 	void DrawBorder(olc::vi2d const& topLeft, olc::vi2d size, int borderWidth, olc::Pixel color);
 
 	void RotateScoreboardCharacter(int direction);
 
-	static olc::Pixel GetColor(TileColor color);
+	void SaveGameOnExit();
+	void RestoreSavedGame();
 
 	olc::vi2d BoardToScreen(int row, int column) const
 	{
@@ -105,23 +255,17 @@ private:
 
 	void DrawTiles();
 
-	void DrawTetronimo(TetronimoInstance const& tetronimo, olc::vi2d origin)
-	{
-		DrawTetronimoSquares(origin, tetronimo.GetTileColor(), tetronimo.GetSquares());
-	}
+	void UpdateBoardMesh();
 
 	void DrawTetronimoSquares(olc::vi2d origin, TileColor tileColor, std::vector<TetronimoSquare> const& squares);
 
-	void DrawTile(int row, int col, olc::Pixel color);
-
-	void DrawTileAtPixel(olc::vi2d pos, olc::Pixel color)
+	void DrawTileAtPixel(olc::vi2d pos, TileColor color)
 	{
-		DrawDecal(pos, m_TileDecal.get(), { 1, 1 }, color);
+		// The sized overload places the quad as DrawDecal does; the scaled one
+		// snaps it a pixel wider
+		olc::vf2d size{ s_TileSizePx, s_TileSizePx };
+		DrawPartialDecal(pos, size, m_TileAtlas.GetDecal(), m_TileAtlas.GetTile(color), size);
 	}
-
-	void DrawTileOutline(int row, int col, BorderDirection directions, olc::Pixel color);
-
-	Input GetInput();
 };
 
 }
@@ -0,0 +1,186 @@
+#include "GlyphCache.h"
+
+#include <algorithm>
+
+namespace BlockDrop
+{
+
+void GlyphCache::DrawString(olc::PixelGameEngine& pge, olc::vi2d pos, std::string_view text, olc::Pixel color, uint32_t scale)
+{
+	if (!CanDraw(pge, color, scale))
+	{
+		pge.DrawString(pos, std::string(text), color, scale);
+		return;
+	}
+
+	olc::Sprite* target = pge.GetDrawTarget();
+	ForEachGlyph(pge, text, scale, [&](Glyph const& glyph, olc::vi2d offset) {
+		FillSpans(target, pos + offset, &m_GlyphSpans[glyph.m_First], glyph.m_Count, color);
+	});
+}
+
+void GlyphCache::DrawStaticString(olc::PixelGameEngine& pge, olc::vi2d pos, std::string_view text, olc::Pixel color, uint32_t scale)
+{
+	if (!CanDraw(pge, color, scale))
+	{
+		pge.DrawString(pos, std::string(text), color, scale);
+		return;
+	}
+
+	RunMap& runs = m_Runs[scale - 1];
+	auto iter = runs.find(text);
+	if (iter == runs.end())
+	{
+		std::vector<Span> spans;
+		ForEachGlyph(pge, text, scale, [&](Glyph const& glyph, olc::vi2d offset) {
+			for (uint32_t i = 0; i < glyph.m_Count; ++i)
+			{
+				Span span = m_GlyphSpans[glyph.m_First + i];
+				span.m_X += static_cast<int16_t>(offset.x);
+				span.m_Y += static_cast<int16_t>(offset.y);
+				spans.push_back(span);
+			}
+		});
+
+		// Join spans that continue into the next character
+		std::sort(spans.begin(), spans.end(), [](Span const& a, Span const& b) {
+			return a.m_Y != b.m_Y ? a.m_Y < b.m_Y : a.m_X < b.m_X;
+		});
+		std::vector<Span> merged;
+		for (Span const& span : spans)
+		{
+			if (!merged.empty() && merged.back().m_Y == span.m_Y
+				&& merged.back().m_X + merged.back().m_Length == span.m_X)
+			{
+				merged.back().m_Length += span.m_Length;
+			}
+			else
+			{
+				merged.push_back(span);
+			}
+		}
+
+		iter = runs.emplace(std::string(text), std::move(merged)).first;
+	}
+
+	FillSpans(pge.GetDrawTarget(), pos, iter->second.data(), iter->second.size(), color);
+}
+
+bool GlyphCache::CanDraw(olc::PixelGameEngine& pge, olc::Pixel color, uint32_t scale)
+{
+	// DrawString blends translucent colours and leaves CUSTOM mode in place;
+	// otherwise it draws in MASK mode, which for an opaque colour is a plain
+	// write
+	return color.a == 255 && pge.GetPixelMode() != olc::Pixel::CUSTOM
+		&& scale >= 1 && scale <= s_MaxScale && pge.GetDrawTarget() != nullptr;
+}
+
+void GlyphCache::BuildGlyphs(olc::PixelGameEngine& pge, uint32_t scale)
+{
+	if (scale < 1 || scale > s_MaxScale)
+	{
+		return;
+	}
+	for (int i = 0; i < s_CharCount; ++i)
+	{
+		GetGlyph(pge, static_cast<char>(s_FirstChar + i), scale);
+	}
+}
+
+GlyphCache::Glyph const& GlyphCache::GetGlyph(olc::PixelGameEngine& pge, char c, uint32_t scale)
+{
+	int index = static_cast<unsigned char>(c) - s_FirstChar;
+	Glyph& glyph = m_Glyphs[(scale - 1) * s_CharCount + index];
+	if (glyph.m_bBuilt)
+	{
+		return glyph;
+	}
+
+	// Same lookup as DrawString: 16 glyphs of 8x8 per font sheet row
+	olc::Sprite* font = pge.GetFontSprite();
+	int ox = (index % 16) * 8;
+	int oy = (index / 16) * 8;
+	int s = static_cast<int>(scale);
+
+	glyph.m_First = static_cast<uint32_t>(m_GlyphSpans.size());
+	for (int j = 0; j < 8; ++j)
+	{
+		for (int i = 0; i < 8;)
+		{
+			if (font->GetPixel(ox + i, oy + j).r == 0)
+			{
+				++i;
+				continue;
+			}
+
+			int start = i;
+			while (i < 8 && font->GetPixel(ox + i, oy + j).r > 0)
+			{
+				++i;
+			}
+			for (int js = 0; js < s; ++js)
+			{
+				m_GlyphSpans.push_back({
+					static_cast<int16_t>(start * s),
+					static_cast<int16_t>(j * s + js),
+					static_cast<int16_t>((i - start) * s) });
+			}
+		}
+	}
+	glyph.m_Count = static_cast<uint32_t>(m_GlyphSpans.size()) - glyph.m_First;
+	glyph.m_bBuilt = true;
+	return glyph;
+}
+
+template <typename Fn>
+void GlyphCache::ForEachGlyph(olc::PixelGameEngine& pge, std::string_view text, uint32_t scale, Fn&& fn)
+{
+	int advance = 8 * static_cast<int>(scale);
+	olc::vi2d offset{ 0, 0 };
+	for (char c : text)
+	{
+		if (c == '\n')
+		{
+			offset.x = 0;
+			offset.y += advance;
+		}
+		else if (c == '\t')
+		{
+			offset.x += advance * olc::nTabSizeInSpaces;
+		}
+		else
+		{
+			// Characters outside the font sheet draw nothing but still advance
+			unsigned char code = static_cast<unsigned char>(c);
+			if (code >= s_FirstChar && code < s_FirstChar + s_CharCount)
+			{
+				fn(GetGlyph(pge, c, scale), offset);
+			}
+			offset.x += advance;
+		}
+	}
+}
+
+void GlyphCache::FillSpans(olc::Sprite* target, olc::vi2d pos, Span const* spans, size_t count, olc::Pixel color)
+{
+	olc::Pixel* pixels = target->GetData();
+	int width = target->width;
+	int height = target->height;
+	for (size_t i = 0; i < count; ++i)
+	{
+		Span const& span = spans[i];
+		int y = pos.y + span.m_Y;
+		if (y < 0 || y >= height)
+		{
+			continue;
+		}
+		int left = std::max(pos.x + span.m_X, 0);
+		int right = std::min(pos.x + span.m_X + span.m_Length, width);
+		if (left < right)
+		{
+			std::fill(pixels + y * width + left, pixels + y * width + right, color);
+		}
+	}
+}
+
+}
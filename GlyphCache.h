@@ -0,0 +1,85 @@
+#pragma once
+#ifndef BLOCKDROP_GLYPH_CACHE_H
+#define BLOCKDROP_GLYPH_CACHE_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "olcPixelGameEngine.h"
+
+namespace BlockDrop
+{
+
+// Draws olc's built-in font as runs of solid pixels instead of testing every
+// font pixel and plotting scale x scale blocks, as DrawString does.
+//
+// Each glyph is expanded once per scale into horizontal spans. Spans are
+// solid, so the colour is applied as they are filled rather than being part
+// of the key. Strings drawn with DrawStaticString also keep their combined,
+// merged spans, so unchanging text is one list of fills.
+//
+// Output matches PixelGameEngine::DrawString for opaque colours outside the
+// CUSTOM pixel mode; anything else, or scales above s_MaxScale, is passed
+// through to it.
+class GlyphCache
+{
+public:
+	static constexpr uint32_t s_MaxScale = 8;
+
+public:
+	void DrawString(olc::PixelGameEngine& pge, olc::vi2d pos, std::string_view text, olc::Pixel color, uint32_t scale = 1);
+	// For text that doesn't change; its spans are kept after the first draw
+	void DrawStaticString(olc::PixelGameEngine& pge, olc::vi2d pos, std::string_view text, olc::Pixel color, uint32_t scale = 1);
+	// Expands every glyph at scale now, so text drawn at it later, whatever
+	// characters it has, doesn't allocate
+	void BuildGlyphs(olc::PixelGameEngine& pge, uint32_t scale);
+
+private:
+	// Relative to the glyph or string origin
+	struct Span
+	{
+		int16_t m_X;
+		int16_t m_Y;
+		int16_t m_Length;
+	};
+
+	// Range in m_GlyphSpans
+	struct Glyph
+	{
+		uint32_t m_First{};
+		uint32_t m_Count{};
+		bool m_bBuilt{ false };
+	};
+
+	struct StringHash
+	{
+		using is_transparent = void;
+		size_t operator()(std::string_view text) const { return std::hash<std::string_view>{}(text); }
+	};
+	using RunMap = std::unordered_map<std::string, std::vector<Span>, StringHash, std::equal_to<>>;
+
+	static constexpr int s_FirstChar = 32;
+	static constexpr int s_CharCount = 96;
+
+private:
+	static bool CanDraw(olc::PixelGameEngine& pge, olc::Pixel color, uint32_t scale);
+	Glyph const& GetGlyph(olc::PixelGameEngine& pge, char c, uint32_t scale);
+	// Calls fn(glyph, offset) for each printable character, laid out as
+	// DrawString lays them out
+	template <typename Fn>
+	void ForEachGlyph(olc::PixelGameEngine& pge, std::string_view text, uint32_t scale, Fn&& fn);
+	static void FillSpans(olc::Sprite* target, olc::vi2d pos, Span const* spans, size_t count, olc::Pixel color);
+
+private:
+	std::vector<Span> m_GlyphSpans;
+	std::array<Glyph, s_CharCount * s_MaxScale> m_Glyphs{};
+	std::array<RunMap, s_MaxScale> m_Runs{};
+};
+
+}
+
+#endif
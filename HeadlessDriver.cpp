@@ -0,0 +1,90 @@
+#include "HeadlessDriver.h"
+
+#if defined(OLC_PGE_HEADLESS)
+#include "SoftwareRenderer.h"
+#endif
+
+namespace BlockDrop
+{
+
+bool HeadlessDriver::Start(int32_t screenWidth, int32_t screenHeight, int32_t pixelSize)
+{
+	if (m_Engine->Construct(screenWidth, screenHeight, pixelSize, pixelSize) != olc::rcode::OK)
+	{
+		return false;
+	}
+
+	// No window, so report one that fits the screen exactly
+	m_Engine->olc_UpdateWindowSize(screenWidth * pixelSize, screenHeight * pixelSize);
+	m_Engine->olc_PrepareEngine();
+	m_Engine->olc_Reanimate();
+
+	if (!m_Engine->OnUserCreate())
+	{
+		m_Engine->olc_Terminate();
+		return false;
+	}
+	return true;
+}
+
+void HeadlessDriver::SetKey(olc::Key key, bool bHeld)
+{
+	m_Engine->olc_UpdateKeyState(key, bHeld);
+}
+
+void HeadlessDriver::SetKeys(ReplayKeys keys)
+{
+	for (size_t i = 0; i < s_ReplayKeys.size(); ++i)
+	{
+		SetKey(s_ReplayKeys[i], (keys >> i) & 1);
+	}
+}
+
+bool HeadlessDriver::Step(float elapsedTime)
+{
+	if (!m_Engine->olc_IsRunning())
+	{
+		return false;
+	}
+
+	m_ElapsedTime = elapsedTime;
+	m_Engine->olc_CoreUpdate();
+	return m_Engine->olc_IsRunning();
+}
+
+olc::vi2d HeadlessDriver::GetFrameSize() const
+{
+#if defined(OLC_PGE_HEADLESS)
+	if (SoftwareRenderer* renderer = SoftwareRenderer::Get())
+	{
+		return renderer->GetFrameSize();
+	}
+#endif
+	return {};
+}
+
+olc::Pixel const* HeadlessDriver::GetFrame() const
+{
+#if defined(OLC_PGE_HEADLESS)
+	if (SoftwareRenderer* renderer = SoftwareRenderer::Get())
+	{
+		return renderer->GetFrame();
+	}
+#endif
+	return nullptr;
+}
+
+bool HeadlessDriver::OnBeforeUserUpdate(float& fElapsedTime)
+{
+	// Replace the engine's wall-clock frame time
+	fElapsedTime = m_ElapsedTime;
+	m_UserUpdateStart = Clock::now();
+	return false;
+}
+
+void HeadlessDriver::OnAfterUserUpdate(float)
+{
+	m_UserUpdateSeconds = std::chrono::duration<double>(Clock::now() - m_UserUpdateStart).count();
+}
+
+}
@@ -0,0 +1,67 @@
+#pragma once
+#ifndef BLOCKDROP_HEADLESS_DRIVER_H
+#define BLOCKDROP_HEADLESS_DRIVER_H
+
+#include <chrono>
+
+#include "olcPixelGameEngine.h"
+
+#include "Replay.h"
+
+namespace BlockDrop
+{
+
+// Runs a PixelGameEngine without a window or engine thread: every Step() is
+// one olc_CoreUpdate() with a caller-chosen frame time and keys, as fast as
+// the CPU allows. Build with OLC_PGE_HEADLESS so frames are rasterized by
+// SoftwareRenderer and can be read back.
+//
+// Construct the driver after the engine; olc extensions attach themselves to
+// the most recently constructed engine.
+class HeadlessDriver : public olc::PGEX
+{
+public:
+	HeadlessDriver()
+		: olc::PGEX(true)
+	{
+	}
+
+	// Construct() plus the setup Start() would do on the engine thread,
+	// including OnUserCreate(). Frames are rasterized at pixelSize times the
+	// screen resolution.
+	bool Start(int32_t screenWidth, int32_t screenHeight, int32_t pixelSize = 1);
+
+	// Held state for the next Step(); presses and releases are derived by the
+	// engine as usual
+	void SetKey(olc::Key key, bool bHeld);
+	void SetKeys(ReplayKeys keys);
+
+	// Returns false once the engine has asked to exit
+	bool Step(float elapsedTime);
+
+	// Time the last Step() spent in the engine's OnUserUpdate(), without the
+	// layer uploads, decals and rasterizing after it
+	double GetUserUpdateSeconds() const { return m_UserUpdateSeconds; }
+
+	// Last frame rasterized, row-major, the size of the screen times the pixel
+	// size. Null before the first Step() or without SoftwareRenderer.
+	olc::vi2d GetFrameSize() const;
+	olc::Pixel const* GetFrame() const;
+
+protected:
+	bool OnBeforeUserUpdate(float& fElapsedTime) override;
+	void OnAfterUserUpdate(float fElapsedTime) override;
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+private:
+	olc::PixelGameEngine* m_Engine{ pge };
+	float m_ElapsedTime{ Replay::s_DefaultFrameTime };
+	Clock::time_point m_UserUpdateStart{};
+	double m_UserUpdateSeconds{};
+};
+
+}
+
+#endif
@@ -0,0 +1,80 @@
+#include "LatencyHistogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace BlockDrop
+{
+
+void LatencyHistogram::Add(double seconds)
+{
+	int bucket = std::clamp(static_cast<int>(seconds / s_BucketSec), 0, s_BucketCount - 1);
+
+	if (m_Count == s_WindowSize)
+	{
+		--m_Counts[m_Window[m_Next]];
+	}
+	else
+	{
+		++m_Count;
+	}
+	m_Window[m_Next] = static_cast<uint16_t>(bucket);
+	++m_Counts[bucket];
+	m_Next = (m_Next + 1) % s_WindowSize;
+	++m_TotalCount;
+}
+
+void LatencyHistogram::Clear()
+{
+	m_Counts.fill(0);
+	m_Next = 0;
+	m_Count = 0;
+	m_TotalCount = 0;
+}
+
+double LatencyHistogram::GetPercentile(double fraction) const
+{
+	if (m_Count == 0)
+	{
+		return 0.0;
+	}
+
+	// The smallest bucket with at least that many samples at or below it
+	int rank = std::max(1, static_cast<int>(std::ceil(fraction * m_Count)));
+	int seen = 0;
+	for (int bucket = 0; bucket < s_BucketCount; ++bucket)
+	{
+		seen += m_Counts[bucket];
+		if (seen >= rank)
+		{
+			return (bucket + 1) * s_BucketSec;
+		}
+	}
+	return s_BucketCount * s_BucketSec;
+}
+
+bool LatencyHistogram::Save(std::string const& path) const
+{
+	std::ofstream file(path);
+	if (!file)
+	{
+		return false;
+	}
+
+	file << "# samples\t" << m_Count << '\n';
+	file << "# p50 ms\t" << GetPercentile(0.50) * 1000.0 << '\n';
+	file << "# p95 ms\t" << GetPercentile(0.95) * 1000.0 << '\n';
+	file << "# p99 ms\t" << GetPercentile(0.99) * 1000.0 << '\n';
+	file << "# up to ms\tcount\n";
+	for (int bucket = 0; bucket < s_BucketCount; ++bucket)
+	{
+		if (m_Counts[bucket] != 0)
+		{
+			file << (bucket + 1) * s_BucketSec * 1000.0 << '\t' << m_Counts[bucket] << '\n';
+		}
+	}
+	return static_cast<bool>(file);
+}
+
+}
@@ -0,0 +1,50 @@
+#pragma once
+#ifndef BLOCKDROP_LATENCY_HISTOGRAM_H
+#define BLOCKDROP_LATENCY_HISTOGRAM_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+namespace BlockDrop
+{
+
+// Counts of the most recent latencies in fixed width buckets. Adding a sample
+// past the window drops the oldest, so percentiles follow what's happening
+// now. Nothing allocates after construction.
+class LatencyHistogram
+{
+public:
+	static constexpr double s_BucketSec = 0.25e-3;
+	// Up to 100 ms; slower samples count in the last bucket
+	static constexpr int s_BucketCount = 400;
+	static constexpr int s_WindowSize = 1024;
+
+public:
+	void Add(double seconds);
+	void Clear();
+
+	// Samples in the window
+	int GetCount() const { return m_Count; }
+	// Samples added since the last Clear(), including those dropped
+	uint64_t GetTotalCount() const { return m_TotalCount; }
+	// Upper edge of the bucket holding that fraction of the window, in
+	// seconds; zero while empty
+	double GetPercentile(double fraction) const;
+
+	// Tab separated: each bucket's upper edge in ms and its count, after a
+	// summary of the percentiles. Returns false if it couldn't be written.
+	bool Save(std::string const& path) const;
+
+private:
+	std::array<uint16_t, s_BucketCount> m_Counts{};
+	// Bucket of each sample in the window, oldest at m_Next once full
+	std::array<uint16_t, s_WindowSize> m_Window{};
+	int m_Next{};
+	int m_Count{};
+	uint64_t m_TotalCount{};
+};
+
+}
+
+#endif
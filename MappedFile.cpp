@@ -0,0 +1,232 @@
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <utility>
+
+#if defined(_WIN32)
+	#if !defined(NOMINMAX)
+		#define NOMINMAX
+	#endif
+	#if !defined(WIN32_LEAN_AND_MEAN)
+		#define WIN32_LEAN_AND_MEAN
+	#endif
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace BlockDrop
+{
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+	*this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+	if (this != &other)
+	{
+		Close();
+		std::swap(m_Data, other.m_Data);
+		std::swap(m_Size, other.m_Size);
+		std::swap(m_bWritable, other.m_bWritable);
+		std::swap(m_File, other.m_File);
+#if defined(_WIN32)
+		std::swap(m_Mapping, other.m_Mapping);
+#endif
+	}
+	return *this;
+}
+
+bool MappedFile::OpenReadOnly(std::string const& path)
+{
+	return Map(path, false, 0);
+}
+
+bool MappedFile::OpenReadWrite(std::string const& path, size_t minimumSize)
+{
+	return Map(path, true, minimumSize);
+}
+
+#if defined(_WIN32)
+
+bool MappedFile::Map(std::string const& path, bool bWritable, size_t minimumSize)
+{
+	Close();
+
+	HANDLE file = CreateFileA(path.c_str(),
+		bWritable ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ,
+		FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+		bWritable ? OPEN_ALWAYS : OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER fileSize{};
+	GetFileSizeEx(file, &fileSize);
+	size_t size = std::max(static_cast<size_t>(fileSize.QuadPart), minimumSize);
+	if (size == 0)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	// Mapping a writable file past its end grows it
+	HANDLE mapping = CreateFileMappingA(file, nullptr, bWritable ? PAGE_READWRITE : PAGE_READONLY,
+		static_cast<DWORD>(static_cast<uint64_t>(size) >> 32), static_cast<DWORD>(size), nullptr);
+	if (mapping == nullptr)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	void* data = MapViewOfFile(mapping, bWritable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, size);
+	if (data == nullptr)
+	{
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	m_File = file;
+	m_Mapping = mapping;
+	m_Data = static_cast<uint8_t*>(data);
+	m_Size = size;
+	m_bWritable = bWritable;
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (m_Data != nullptr)
+	{
+		UnmapViewOfFile(m_Data);
+		CloseHandle(m_Mapping);
+		CloseHandle(m_File);
+	}
+	m_Data = nullptr;
+	m_Mapping = nullptr;
+	m_File = nullptr;
+	m_Size = 0;
+	m_bWritable = false;
+}
+
+void MappedFile::Advise(Advice advice, size_t offset, size_t length) const
+{
+}
+
+void MappedFile::Flush() const
+{
+	if (m_Data != nullptr && m_bWritable)
+	{
+		FlushViewOfFile(m_Data, 0);
+	}
+}
+
+#else
+
+bool MappedFile::Map(std::string const& path, bool bWritable, size_t minimumSize)
+{
+	Close();
+
+	int file = open(path.c_str(), bWritable ? (O_RDWR | O_CREAT) : O_RDONLY, 0644);
+	if (file < 0)
+	{
+		return false;
+	}
+
+	struct stat info{};
+	if (fstat(file, &info) != 0)
+	{
+		close(file);
+		return false;
+	}
+
+	size_t size = static_cast<size_t>(info.st_size);
+	if (bWritable && size < minimumSize)
+	{
+		if (ftruncate(file, static_cast<off_t>(minimumSize)) != 0)
+		{
+			close(file);
+			return false;
+		}
+		size = minimumSize;
+	}
+	if (size == 0)
+	{
+		close(file);
+		return false;
+	}
+
+	void* data = mmap(nullptr, size, bWritable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, file, 0);
+	if (data == MAP_FAILED)
+	{
+		close(file);
+		return false;
+	}
+
+	m_File = file;
+	m_Data = static_cast<uint8_t*>(data);
+	m_Size = size;
+	m_bWritable = bWritable;
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (m_Data != nullptr)
+	{
+		munmap(m_Data, m_Size);
+		close(m_File);
+	}
+	m_Data = nullptr;
+	m_File = -1;
+	m_Size = 0;
+	m_bWritable = false;
+}
+
+void MappedFile::Advise(Advice advice, size_t offset, size_t length) const
+{
+	if (m_Data == nullptr || offset >= m_Size)
+	{
+		return;
+	}
+
+	// madvise wants a page-aligned start
+	size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+	size_t start = offset - (offset % pageSize);
+	size_t end = (length >= m_Size - offset) ? m_Size : offset + length;
+
+	int native = MADV_NORMAL;
+	switch (advice)
+	{
+	case Advice::Random:
+		native = MADV_RANDOM;
+		break;
+	case Advice::Sequential:
+		native = MADV_SEQUENTIAL;
+		break;
+	case Advice::WillNeed:
+		native = MADV_WILLNEED;
+		break;
+	}
+	madvise(m_Data + start, end - start, native);
+}
+
+void MappedFile::Flush() const
+{
+	if (m_Data != nullptr && m_bWritable)
+	{
+		msync(m_Data, m_Size, MS_SYNC);
+	}
+}
+
+#endif
+
+}
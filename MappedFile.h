@@ -0,0 +1,66 @@
+#pragma once
+#ifndef BLOCKDROP_MAPPED_FILE_H
+#define BLOCKDROP_MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace BlockDrop
+{
+
+// Whole-file memory mapping, used by the dataset and position database tools.
+class MappedFile
+{
+public:
+	enum class Advice
+	{
+		Random,
+		Sequential,
+		WillNeed,
+	};
+
+public:
+	MappedFile() = default;
+	MappedFile(MappedFile&) = delete;
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+	~MappedFile()
+	{
+		Close();
+	}
+
+	bool OpenReadOnly(std::string const& path);
+	// Creates the file if needed and grows it to at least minimumSize bytes.
+	// New bytes read as zero.
+	bool OpenReadWrite(std::string const& path, size_t minimumSize);
+	void Close();
+
+	bool IsOpen() const { return m_Data != nullptr; }
+	uint8_t const* Data() const { return m_Data; }
+	uint8_t* MutableData() { return m_bWritable ? m_Data : nullptr; }
+	size_t Size() const { return m_Size; }
+
+	// Paging hints; no-ops where the platform has no equivalent
+	void Advise(Advice advice, size_t offset = 0, size_t length = SIZE_MAX) const;
+	// Writes dirty pages back to the file
+	void Flush() const;
+
+private:
+	bool Map(std::string const& path, bool bWritable, size_t minimumSize);
+
+private:
+	uint8_t* m_Data{};
+	size_t m_Size{};
+	bool m_bWritable{ false };
+#if defined(_WIN32)
+	void* m_File{};
+	void* m_Mapping{};
+#else
+	int m_File{ -1 };
+#endif
+};
+
+}
+
+#endif
@@ -0,0 +1,161 @@
+#include "Mosaic.h"
+
+#include <algorithm>
+#include <string>
+
+namespace BlockDrop
+{
+
+namespace
+{
+
+// Length of each board's scripted game before it repeats
+constexpr size_t s_ScriptFrames = 3600;
+
+}
+
+Mosaic::Mosaic(int boardCount, uint32_t seed)
+{
+	sAppName = "BlockDrop Mosaic";
+
+	boardCount = std::clamp(boardCount, 1, s_MaxBoards);
+	m_Boards.resize(boardCount);
+	for (int i = 0; i < boardCount; ++i)
+	{
+		uint32_t boardSeed = seed + static_cast<uint32_t>(i);
+		m_Boards[i].m_Sim = std::make_unique<Sim>(s_BoardTileWidth, s_BoardTileHeight, boardSeed);
+		m_Boards[i].m_Script = Replay::MakeScripted(boardSeed, s_ScriptFrames);
+	}
+
+	Layout();
+}
+
+bool Mosaic::OnUserCreate()
+{
+	olc::Sprite tile("tile.png");
+	m_TileAtlas.Build(*this, tile, m_TileSizePx);
+
+	m_StaticUiLayer = static_cast<uint8_t>(CreateLayer());
+	SetDrawTarget(m_StaticUiLayer);
+	DrawStaticUI();
+	EnableLayer(m_StaticUiLayer, true);
+	SetDrawTarget(nullptr);
+
+	// Layer 0 only holds the scores, redrawn as they change
+	Clear(olc::BLANK);
+
+	return true;
+}
+
+bool Mosaic::OnUserUpdate(float fElapsedTime)
+{
+	for (int i = 0; i < GetBoardCount(); ++i)
+	{
+		Board& board = m_Boards[i];
+		Sim& sim = *board.m_Sim;
+
+		Input input = m_InputSource ? m_InputSource(i, sim) : GetScriptedInput(board);
+		sim.Update(fElapsedTime, input);
+		if (sim.IsGameOver())
+		{
+			sim.ResetGame();
+			++m_GamesPlayed;
+		}
+
+		if (sim.GetChanges().HasAny())
+		{
+			board.m_Mesh.m_bDirty = true;
+		}
+		sim.ClearChanges();
+	}
+	++m_FrameIndex;
+
+	// Only boards that changed rebuild their part of the mesh
+	m_FrameMesh.Clear();
+	for (Board& board : m_Boards)
+	{
+		if (board.m_Mesh.m_bDirty)
+		{
+			board.m_Mesh.m_bDirty = false;
+			board.m_Snapshot.Capture(*board.m_Sim);
+			board.m_Mesh.Clear();
+			board.m_Mesh.AddBoard(board.m_Snapshot, board.m_TopLeft, m_TileAtlas);
+		}
+		m_FrameMesh.Append(board.m_Mesh);
+	}
+	m_FrameMesh.Draw(*this, m_TileAtlas);
+
+	bool bScoresChanged = false;
+	for (Board& board : m_Boards)
+	{
+		int score = board.m_Sim->GetScore();
+		if (score == board.m_DrawnScore)
+		{
+			continue;
+		}
+
+		olc::vi2d pos = GetScorePos(board);
+		FillRect(pos, { s_BoardTileWidth * m_TileSizePx, 8 }, olc::BLANK);
+		m_GlyphCache.DrawString(*this, pos, std::to_string(score), olc::WHITE);
+		board.m_DrawnScore = score;
+		bScoresChanged = true;
+	}
+
+	// Re-uploaded only if a score was redrawn
+	SetDrawTarget(uint8_t{ 0 }, bScoresChanged);
+
+	return true;
+}
+
+void Mosaic::Layout()
+{
+	// Try every column count and keep whichever allows the largest tiles
+	int boardCount = GetBoardCount();
+	int bestColumns = 1;
+	m_TileSizePx = 0;
+	for (int columns = 1; columns <= boardCount; ++columns)
+	{
+		int rows = (boardCount + columns - 1) / columns;
+		int cellWidth = s_ScreenWidthPx / columns - 2 * s_BoardMarginPx;
+		int cellHeight = s_ScreenHeightPx / rows - 2 * s_BoardMarginPx - s_ScoreHeightPx;
+		int tileSize = std::min(cellWidth / s_BoardTileWidth, cellHeight / s_BoardTileHeight);
+		if (tileSize > m_TileSizePx)
+		{
+			m_TileSizePx = tileSize;
+			bestColumns = columns;
+		}
+	}
+	m_TileSizePx = std::clamp(m_TileSizePx, 1, s_MaxTileSizePx);
+
+	int rows = (boardCount + bestColumns - 1) / bestColumns;
+	olc::vi2d cellSize{ s_ScreenWidthPx / bestColumns, s_ScreenHeightPx / rows };
+	olc::vi2d boardSize{ s_BoardTileWidth * m_TileSizePx, s_BoardTileHeight * m_TileSizePx + s_ScoreHeightPx };
+	for (int i = 0; i < boardCount; ++i)
+	{
+		olc::vi2d cell{ i % bestColumns, i / bestColumns };
+		m_Boards[i].m_TopLeft = cell * cellSize + (cellSize - boardSize) / 2;
+	}
+}
+
+void Mosaic::DrawStaticUI()
+{
+	Clear(olc::VERY_DARK_GREY);
+
+	olc::vi2d size{ s_BoardTileWidth * m_TileSizePx, s_BoardTileHeight * m_TileSizePx };
+	for (Board const& board : m_Boards)
+	{
+		DrawRect(board.m_TopLeft - olc::vi2d{ 1, 1 }, size + olc::vi2d{ 1, 1 }, olc::GREY);
+		FillRect(board.m_TopLeft, size, olc::BLACK);
+	}
+}
+
+Input Mosaic::GetScriptedInput(Board& board)
+{
+	size_t frame = m_FrameIndex % board.m_Script.GetFrameCount();
+	ReplayKeys keys = board.m_Script.GetKeys(frame);
+	Input input = InputFromKeys(keys, board.m_PreviousKeys);
+	board.m_PreviousKeys = keys;
+	return input;
+}
+
+}
@@ -0,0 +1,100 @@
+#pragma once
+#ifndef BLOCKDROP_MOSAIC_H
+#define BLOCKDROP_MOSAIC_H
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "olcPixelGameEngine.h"
+
+#include "GlyphCache.h"
+#include "Replay.h"
+#include "Sim.h"
+#include "SimSnapshot.h"
+#include "TileAtlas.h"
+
+namespace BlockDrop
+{
+
+// Spectator view of many boards at once, for watching bot tournaments. Boards
+// are laid out in a grid at the largest tile size that fits and share one
+// atlas built at that size. Every board's tiles go into a single triangle list,
+// so the whole mosaic is one decal. A board whose game ends starts a new one.
+class Mosaic : public olc::PixelGameEngine
+{
+public:
+	static constexpr int s_ScreenWidthPx = 1280;
+	static constexpr int s_ScreenHeightPx = 720;
+
+	static constexpr int s_MaxBoards = 64;
+	static constexpr int s_BoardTileWidth = 10;
+	static constexpr int s_BoardTileHeight = 20;
+
+	// tile.png's size; boards are never drawn larger
+	static constexpr int s_MaxTileSizePx = 26;
+
+	// Space around each board, and under it for the score
+	static constexpr int s_BoardMarginPx = 4;
+	static constexpr int s_ScoreHeightPx = 10;
+
+	// Picks the input for a board each frame; by default each board plays a
+	// scripted game from its own seed
+	using InputSource = std::function<Input(int board, Sim const& sim)>;
+
+public:
+	Mosaic(int boardCount, uint32_t seed);
+
+	void SetInputSource(InputSource inputSource) { m_InputSource = std::move(inputSource); }
+
+	int GetBoardCount() const { return static_cast<int>(m_Boards.size()); }
+	int GetTileSize() const { return m_TileSizePx; }
+	Sim const& GetSim(int board) const { return *m_Boards[board].m_Sim; }
+	// Games finished across all boards
+	int GetGamesPlayed() const { return m_GamesPlayed; }
+
+	bool OnUserCreate() override;
+	bool OnUserUpdate(float fElapsedTime) override;
+
+private:
+	struct Board
+	{
+		std::unique_ptr<Sim> m_Sim;
+		olc::vi2d m_TopLeft{};
+		SimSnapshot m_Snapshot{};
+		BoardMesh m_Mesh{};
+		int m_DrawnScore{ -1 };
+
+		Replay m_Script{};
+		ReplayKeys m_PreviousKeys{};
+	};
+
+private:
+	void Layout();
+	void DrawStaticUI();
+	Input GetScriptedInput(Board& board);
+
+	olc::vi2d GetScorePos(Board const& board) const
+	{
+		return board.m_TopLeft + olc::vi2d{ 0, s_BoardTileHeight * m_TileSizePx + 2 };
+	}
+
+private:
+	std::vector<Board> m_Boards;
+	InputSource m_InputSource{};
+	uint64_t m_FrameIndex{};
+	int m_GamesPlayed{};
+
+	int m_TileSizePx{};
+	TileAtlas m_TileAtlas{};
+	GlyphCache m_GlyphCache{};
+	// Board backgrounds and borders, drawn once behind layer 0
+	uint8_t m_StaticUiLayer{};
+
+	// Every board's mesh, appended each frame for a single draw
+	BoardMesh m_FrameMesh{};
+};
+
+}
+
+#endif
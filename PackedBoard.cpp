@@ -0,0 +1,99 @@
+#include "PackedBoard.h"
+
+namespace BlockDrop
+{
+
+PackedBoard::PackedBoard(int width, int height)
+	: m_Width(static_cast<uint8_t>(width))
+	, m_Height(static_cast<uint8_t>(height))
+{
+	assert(width > 0 && width <= 32);
+	assert(width * height <= s_MaxCells);
+}
+
+PackedBoard::PackedBoard(std::vector<TileColor> const& tiles, int width, int height)
+	: PackedBoard(width, height)
+{
+	assert(static_cast<int>(tiles.size()) == width * height);
+
+	for (int cell = 0; cell < width * height; ++cell)
+	{
+		if (tiles[cell] != TileColor::None)
+		{
+			m_Occupancy[cell >> 6] |= uint64_t{ 1 } << (cell & 63);
+		}
+	}
+}
+
+void PackedBoard::SetOccupied(int row, int col, bool occupied)
+{
+	int bit = row * m_Width + col;
+	uint64_t mask = uint64_t{ 1 } << (bit & 63);
+	if (occupied)
+	{
+		m_Occupancy[bit >> 6] |= mask;
+	}
+	else
+	{
+		m_Occupancy[bit >> 6] &= ~mask;
+	}
+}
+
+uint32_t PackedBoard::RowMask(int row) const
+{
+	int bit = row * m_Width;
+	int word = bit >> 6;
+	int shift = bit & 63;
+
+	uint64_t bits = m_Occupancy[word] >> shift;
+	if (shift + m_Width > 64)
+	{
+		// Row straddles two words
+		bits |= m_Occupancy[word + 1] << (64 - shift);
+	}
+
+	return static_cast<uint32_t>(bits & ((uint64_t{ 1 } << m_Width) - 1));
+}
+
+uint64_t PackedBoard::Hash() const
+{
+	// splitmix64 finalizer over each word, chained
+	auto mix = [](uint64_t x) {
+		x ^= x >> 30;
+		x *= 0xbf58476d1ce4e5b9ull;
+		x ^= x >> 27;
+		x *= 0x94d049bb133111ebull;
+		x ^= x >> 31;
+		return x;
+	};
+
+	uint64_t hash = mix((static_cast<uint64_t>(m_Width) << 8) | m_Height);
+	for (uint64_t word : m_Occupancy)
+	{
+		hash = mix(hash ^ word);
+	}
+	return hash;
+}
+
+PackedColorPlane::PackedColorPlane(std::vector<TileColor> const& tiles, int width, int height)
+	: m_Width(static_cast<uint8_t>(width))
+	, m_Height(static_cast<uint8_t>(height))
+{
+	assert(width * height <= s_MaxCells);
+	assert(static_cast<int>(tiles.size()) == width * height);
+
+	for (int cell = 0; cell < width * height; ++cell)
+	{
+		m_Nibbles[cell >> 1] |= static_cast<uint8_t>(static_cast<uint8_t>(tiles[cell]) << ((cell & 1) * 4));
+	}
+}
+
+void PackedColorPlane::Set(int row, int col, TileColor color)
+{
+	int cell = row * m_Width + col;
+	int shift = (cell & 1) * 4;
+	uint8_t& pair = m_Nibbles[cell >> 1];
+	pair = static_cast<uint8_t>((pair & ~(0xF << shift)) | (static_cast<uint8_t>(color) << shift));
+}
+
+}
@@ -0,0 +1,111 @@
+#pragma once
+#ifndef BLOCKDROP_PACKED_BOARD_H
+#define BLOCKDROP_PACKED_BOARD_H
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "Sim.h"
+
+namespace BlockDrop
+{
+
+// Compact storage for boards that are kept around in bulk (search, datasets)
+// rather than simulated. Anything up to s_MaxCells cells fits.
+//
+// Memory per stored 10x20 position:
+//   Sim::Tiles()       200 bytes + 24 byte vector header + heap block
+//   PackedBoard         40 bytes (200 occupancy bits, padded, plus dimensions)
+//   PackedColorPlane   130 bytes (4 bits per cell), only needed for drawing
+static constexpr int s_PackedBoardMaxCells = 256;
+
+// 1 bit per cell, row-major. Enough for collision and line checks.
+class PackedBoard
+{
+public:
+	static constexpr int s_MaxCells = s_PackedBoardMaxCells;
+
+public:
+	PackedBoard() = default;
+	PackedBoard(int width, int height);
+	PackedBoard(std::vector<TileColor> const& tiles, int width, int height);
+	explicit PackedBoard(Sim const& sim)
+		: PackedBoard(sim.Tiles(), sim.GetWidth(), sim.GetHeight())
+	{
+	}
+
+	int GetWidth() const { return m_Width; }
+	int GetHeight() const { return m_Height; }
+
+	bool IsOccupied(int row, int col) const
+	{
+		int bit = row * m_Width + col;
+		return (m_Occupancy[bit >> 6] >> (bit & 63)) & 1;
+	}
+
+	void SetOccupied(int row, int col, bool occupied);
+
+	// Occupancy of one row, bit N set for column N
+	uint32_t RowMask(int row) const;
+
+	bool IsRowFilled(int row) const
+	{
+		// 64-bit shift, so a 32 wide board doesn't shift a uint32_t by 32
+		return RowMask(row) == static_cast<uint32_t>((uint64_t{ 1 } << m_Width) - 1);
+	}
+
+	std::array<uint64_t, s_MaxCells / 64> const& Words() const { return m_Occupancy; }
+
+	// 64-bit mix of the occupancy and dimensions, for hash tables
+	uint64_t Hash() const;
+
+	bool operator==(PackedBoard const& other) const = default;
+
+private:
+	std::array<uint64_t, s_MaxCells / 64> m_Occupancy{};
+	uint8_t m_Width{};
+	uint8_t m_Height{};
+	// Spelled out so boards written to disk have no indeterminate bytes
+	uint8_t m_Padding[6]{};
+};
+static_assert(sizeof(PackedBoard) == 40, "PackedBoard size is documented above");
+
+// 4 bits per cell, row-major. Only the renderer needs colors, so this is kept
+// separate from the occupancy bits.
+class PackedColorPlane
+{
+public:
+	static constexpr int s_MaxCells = s_PackedBoardMaxCells;
+
+public:
+	PackedColorPlane() = default;
+	PackedColorPlane(std::vector<TileColor> const& tiles, int width, int height);
+	explicit PackedColorPlane(Sim const& sim)
+		: PackedColorPlane(sim.Tiles(), sim.GetWidth(), sim.GetHeight())
+	{
+	}
+
+	int GetWidth() const { return m_Width; }
+	int GetHeight() const { return m_Height; }
+
+	TileColor At(int row, int col) const
+	{
+		int cell = row * m_Width + col;
+		return static_cast<TileColor>((m_Nibbles[cell >> 1] >> ((cell & 1) * 4)) & 0xF);
+	}
+
+	void Set(int row, int col, TileColor color);
+
+	bool operator==(PackedColorPlane const& other) const = default;
+
+private:
+	std::array<uint8_t, s_MaxCells / 2> m_Nibbles{};
+	uint8_t m_Width{};
+	uint8_t m_Height{};
+};
+static_assert(sizeof(PackedColorPlane) == 130, "PackedColorPlane size is documented above");
+
+}
+
+#endif
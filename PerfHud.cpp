@@ -0,0 +1,137 @@
+#include "PerfHud.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace BlockDrop
+{
+
+namespace
+{
+
+constexpr int s_MarginPx = 4;
+constexpr int s_LineHeightPx = 10;
+constexpr int s_TextLines = 1 + static_cast<int>(PerfPhase::Count) + 2;
+constexpr int s_HeightPx = 2 * s_MarginPx + s_TextLines * s_LineHeightPx + PerfHud::s_GraphHeightPx + 4;
+
+// Share of each new frame in the smoothed phase times
+constexpr float s_AverageWeight = 0.05f;
+constexpr float s_FrameBudgetMs = 1000.f / 60.f;
+
+constexpr std::array<char const*, static_cast<size_t>(PerfPhase::Count)> s_PhaseNames{
+	"input", "sim", "ui", "tiles", "hud", "present",
+};
+
+}
+
+void PerfHud::Create()
+{
+	m_Sprite = std::make_unique<olc::Sprite>(s_WidthPx, s_HeightPx);
+	m_Decal = std::make_unique<olc::Decal>(m_Sprite.get());
+}
+
+void PerfHud::BeginFrame(float elapsedTime)
+{
+	m_PhaseStart = Clock::now();
+	m_FrameAllocationScope.Reset();
+
+	m_ElapsedMs = elapsedTime * 1000.f;
+	m_FrameMs[m_HistoryNext] = m_ElapsedMs;
+	m_HistoryNext = (m_HistoryNext + 1) % s_HistoryFrames;
+}
+
+void PerfHud::EndPhase(PerfPhase phase)
+{
+	Clock::time_point now = Clock::now();
+	m_PhaseMs[static_cast<int>(phase)] += std::chrono::duration<float, std::milli>(now - m_PhaseStart).count();
+	m_PhaseStart = now;
+}
+
+void PerfHud::CountDecals(olc::PixelGameEngine& pge)
+{
+	auto const& layers = pge.GetLayers();
+	m_LayerCount = std::min(static_cast<int>(layers.size()), s_MaxLayers);
+	for (int i = 0; i < m_LayerCount; ++i)
+	{
+		m_DecalCounts[i] = static_cast<int>(layers[i].nDecalInstances);
+	}
+}
+
+void PerfHud::EndFrame()
+{
+	EndPhase(PerfPhase::Present);
+	m_FrameAllocations = m_FrameAllocationScope.GetCount();
+
+	for (int i = 0; i < s_PhaseCount; ++i)
+	{
+		m_AveragePhaseMs[i] += (m_PhaseMs[i] - m_AveragePhaseMs[i]) * s_AverageWeight;
+		m_PhaseMs[i] = 0.f;
+	}
+}
+
+void PerfHud::Draw(olc::PixelGameEngine& pge, GlyphCache& glyphCache, olc::vi2d pos)
+{
+	pge.SetDrawTarget(m_Sprite.get());
+	pge.Clear(olc::Pixel(0, 0, 0, 192));
+
+	char line[32];
+	olc::vi2d textPos{ s_MarginPx, s_MarginPx };
+	auto drawLine = [&](olc::Pixel color) {
+		glyphCache.DrawString(pge, textPos, line, color);
+		textPos.y += s_LineHeightPx;
+	};
+
+	float maxMs = *std::max_element(m_FrameMs.begin(), m_FrameMs.end());
+	std::snprintf(line, sizeof(line), "frame %5.1f max %5.1f", m_ElapsedMs, maxMs);
+	drawLine(olc::WHITE);
+
+	// Oldest on the left, with a line at the 60 fps budget
+	int graphBottom = textPos.y + s_GraphHeightPx;
+	auto graphHeight = [&](float ms) {
+		return std::clamp(static_cast<int>(ms / s_GraphMaxMs * s_GraphHeightPx + 0.5f), 0, s_GraphHeightPx);
+	};
+	for (int i = 0; i < s_HistoryFrames; ++i)
+	{
+		float ms = m_FrameMs[(m_HistoryNext + i) % s_HistoryFrames];
+		int height = graphHeight(ms);
+		if (height > 0)
+		{
+			int x = s_MarginPx + i;
+			pge.DrawLine(x, graphBottom - height, x, graphBottom - 1, ms > s_FrameBudgetMs * 1.05f ? olc::RED : olc::DARK_GREEN);
+		}
+	}
+	int budgetY = graphBottom - graphHeight(s_FrameBudgetMs);
+	pge.DrawLine(s_MarginPx, budgetY, s_MarginPx + s_HistoryFrames - 1, budgetY, olc::GREY);
+	textPos.y = graphBottom + 4;
+
+	for (int i = 0; i < s_PhaseCount; ++i)
+	{
+		if (static_cast<PerfPhase>(i) == PerfPhase::Sim)
+		{
+			std::snprintf(line, sizeof(line), "%-7s %6.3f (%.3f)", s_PhaseNames[i], m_AveragePhaseMs[i], m_SimStepMs);
+		}
+		else
+		{
+			std::snprintf(line, sizeof(line), "%-7s %6.3f", s_PhaseNames[i], m_AveragePhaseMs[i]);
+		}
+		drawLine(olc::GREY);
+	}
+
+	int length = std::snprintf(line, sizeof(line), "decals");
+	for (int i = 0; i < m_LayerCount && length < static_cast<int>(sizeof(line)); ++i)
+	{
+		length += std::snprintf(line + length, sizeof(line) - length, " %d", m_DecalCounts[i]);
+	}
+	drawLine(olc::WHITE);
+
+#if defined(BLOCKDROP_COUNT_ALLOCATIONS)
+	std::snprintf(line, sizeof(line), "allocs %llu", static_cast<unsigned long long>(m_FrameAllocations));
+	drawLine(m_FrameAllocations > 0 ? olc::YELLOW : olc::WHITE);
+#endif
+
+	pge.SetDrawTarget(nullptr);
+	m_Decal->Update();
+	pge.DrawDecal(pos, m_Decal.get());
+}
+
+}
@@ -0,0 +1,98 @@
+#pragma once
+#ifndef BLOCKDROP_PERF_HUD_H
+#define BLOCKDROP_PERF_HUD_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+#include "olcPixelGameEngine.h"
+
+#include "AllocationCounter.h"
+#include "GlyphCache.h"
+
+namespace BlockDrop
+{
+
+// Where a frame's time goes on the engine thread, in order
+enum class PerfPhase
+{
+	Input,
+	Sim,
+	Ui,
+	// The board area: tiles, or the overlay covering them
+	Tiles,
+	Hud,
+	// Layer uploads, decals and presenting, after OnUserUpdate
+	Present,
+	Count,
+};
+
+// Frame timings for a heads-up display: a graph of recent frame times, the
+// time each phase takes, decals queued per layer and allocations per frame.
+// Timings are always taken, so the graph is full as soon as it's shown.
+//
+// The HUD draws into its own sprite and shows it as one decal, leaving
+// layer 0 and its dirty rectangles alone. Its buffers are all made up front;
+// nothing allocates per frame.
+class PerfHud
+{
+public:
+	static constexpr int s_WidthPx = 184;
+	static constexpr int s_GraphHeightPx = 40;
+	static constexpr int s_HistoryFrames = s_WidthPx - 8;
+	// Graph height in ms; slower frames are clipped
+	static constexpr float s_GraphMaxMs = 50.f;
+	static constexpr int s_MaxLayers = 4;
+
+public:
+	// Needs the renderer, so call from OnUserCreate()
+	void Create();
+
+	// Starts timing a frame; elapsedTime is since the last one started
+	void BeginFrame(float elapsedTime);
+	// The time since the last EndPhase(), or BeginFrame(), is phase's
+	void EndPhase(PerfPhase phase);
+	// Decals queued on each layer, before the engine draws them
+	void CountDecals(olc::PixelGameEngine& pge);
+	// After the frame is presented: ends PerfPhase::Present and the frame
+	void EndFrame();
+
+	// Time the Sim thread spent on its last steps, to show beside the phases
+	void SetSimStepTime(double seconds) { m_SimStepMs = static_cast<float>(seconds * 1000.0); }
+
+	// Redraws the HUD sprite and queues it as a decal at pos, on the current
+	// layer. Leaves the draw target on layer 0, without marking it dirty.
+	void Draw(olc::PixelGameEngine& pge, GlyphCache& glyphCache, olc::vi2d pos);
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	static constexpr int s_PhaseCount = static_cast<int>(PerfPhase::Count);
+
+private:
+	std::unique_ptr<olc::Sprite> m_Sprite{};
+	std::unique_ptr<olc::Decal> m_Decal{};
+
+	Clock::time_point m_PhaseStart{};
+	// This frame's time per phase, and a smoothed average for display
+	std::array<float, s_PhaseCount> m_PhaseMs{};
+	std::array<float, s_PhaseCount> m_AveragePhaseMs{};
+	float m_SimStepMs{};
+
+	// Frame times, oldest at m_HistoryNext
+	std::array<float, s_HistoryFrames> m_FrameMs{};
+	int m_HistoryNext{};
+	float m_ElapsedMs{};
+
+	std::array<int, s_MaxLayers> m_DecalCounts{};
+	int m_LayerCount{};
+
+	AllocationScope m_FrameAllocationScope{};
+	uint64_t m_FrameAllocations{};
+};
+
+}
+
+#endif
@@ -0,0 +1,317 @@
+#include "PositionDatabase.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <thread>
+
+namespace BlockDrop
+{
+
+static constexpr uint32_t s_PositionDatabaseMagic = 0x42445042; // "BPDB"
+static constexpr uint32_t s_PositionDatabaseVersion = 1;
+
+// Entry::m_State. A claimed slot is published within microseconds unless its
+// writer died first; inserts that find one still unpublished after
+// s_ClaimTimeout give up on it for good.
+static constexpr uint32_t s_EntryWriting = 0;
+static constexpr uint32_t s_EntryReady = 1;
+static constexpr uint32_t s_EntryAbandoned = 2;
+static constexpr auto s_ClaimTimeout = std::chrono::seconds(1);
+
+struct PositionDatabase::Header
+{
+	uint32_t m_Magic;
+	uint32_t m_Version;
+	uint32_t m_EntrySize;
+	uint32_t m_Reserved;
+	uint64_t m_Capacity;
+	uint64_t m_EntryCount;
+	uint8_t m_Padding[32];
+};
+
+struct PositionDatabase::Entry
+{
+	// 0 while the slot is free
+	uint64_t m_Key;
+	// s_EntryWriting until m_Board and m_Piece are written, then s_EntryReady
+	uint32_t m_State;
+	TileColor m_Piece;
+	uint8_t m_Padding[3];
+	PackedBoard m_Board;
+	uint64_t m_VisitCount;
+	int64_t m_FutureScoreSum;
+	// Biased best score in the high half, so it can be maxed as a single
+	// unsigned value, and BestPlacement bits in the low half
+	uint64_t m_Best;
+};
+
+namespace
+{
+
+// Low half of Entry::m_Best; m_bValid distinguishes "no placement" from 0s
+struct BestPlacement
+{
+	uint8_t m_bValid;
+	uint8_t m_Rotation;
+	int8_t m_Column;
+	int8_t m_Row;
+};
+
+uint64_t PackBest(int futureScore, int rotation, int column, int row)
+{
+	BestPlacement placement{ 1, static_cast<uint8_t>(rotation), static_cast<int8_t>(column), static_cast<int8_t>(row) };
+	uint32_t low;
+	std::memcpy(&low, &placement, sizeof(low));
+	uint32_t biasedScore = static_cast<uint32_t>(futureScore) ^ 0x80000000u;
+	return (static_cast<uint64_t>(biasedScore) << 32) | low;
+}
+
+uint64_t PositionKey(PackedBoard const& board, TileColor piece)
+{
+	uint64_t key = board.Hash() ^ (static_cast<uint64_t>(piece) * 0x9e3779b97f4a7c15ull);
+	return key != 0 ? key : 1;
+}
+
+}
+
+bool PositionDatabase::IsValidHeader(uint8_t const* data, size_t size)
+{
+	if (size < sizeof(Header))
+	{
+		return false;
+	}
+	Header header{};
+	std::memcpy(&header, data, sizeof(header));
+	return header.m_Magic == s_PositionDatabaseMagic
+		&& header.m_Version == s_PositionDatabaseVersion
+		&& header.m_EntrySize == sizeof(Entry)
+		&& header.m_Capacity != 0
+		&& (header.m_Capacity & (header.m_Capacity - 1)) == 0
+		&& header.m_Capacity <= (size - sizeof(Header)) / sizeof(Entry);
+}
+
+bool PositionDatabase::Open(std::string const& path, uint64_t capacity)
+{
+	static_assert(sizeof(Header) == 64, "Header layout is part of the file format");
+	static_assert(sizeof(Entry) == 80, "Entry layout is part of the file format");
+
+	Close();
+
+	uint64_t roundedCapacity = 1;
+	while (roundedCapacity < capacity)
+	{
+		roundedCapacity <<= 1;
+	}
+
+	// Only a missing or empty file is made into a new table; anything else has
+	// to already be a database, and is checked before it's opened for writing
+	// so a stray or truncated file is never grown
+	std::error_code error;
+	uintmax_t existingSize = std::filesystem::file_size(path, error);
+	if (error || existingSize == 0)
+	{
+		// A new file maps as zeroes: an empty table once the header is filled in
+		size_t size = sizeof(Header) + roundedCapacity * sizeof(Entry);
+		if (!m_File.OpenReadWrite(path, size))
+		{
+			return false;
+		}
+		Header header{};
+		header.m_Magic = s_PositionDatabaseMagic;
+		header.m_Version = s_PositionDatabaseVersion;
+		header.m_EntrySize = sizeof(Entry);
+		header.m_Capacity = roundedCapacity;
+		std::memcpy(m_File.MutableData(), &header, sizeof(header));
+	}
+	else
+	{
+		// An existing file keeps its own capacity
+		if (!m_File.OpenReadOnly(path) || !IsValidHeader(m_File.Data(), m_File.Size()))
+		{
+			m_File.Close();
+			return false;
+		}
+		m_File.Close();
+		if (!m_File.OpenReadWrite(path, 0) || !IsValidHeader(m_File.Data(), m_File.Size()))
+		{
+			m_File.Close();
+			return false;
+		}
+	}
+
+	// Probes jump around the table
+	m_File.Advise(MappedFile::Advice::Random);
+	return true;
+}
+
+void PositionDatabase::Close()
+{
+	m_File.Close();
+}
+
+void PositionDatabase::Flush() const
+{
+	m_File.Flush();
+}
+
+PositionDatabase::Header* PositionDatabase::GetHeader() const
+{
+	return reinterpret_cast<Header*>(const_cast<uint8_t*>(m_File.Data()));
+}
+
+PositionDatabase::Entry* PositionDatabase::GetEntries() const
+{
+	return reinterpret_cast<Entry*>(const_cast<uint8_t*>(m_File.Data()) + sizeof(Header));
+}
+
+uint64_t PositionDatabase::GetCapacity() const
+{
+	return m_File.IsOpen() ? GetHeader()->m_Capacity : 0;
+}
+
+uint64_t PositionDatabase::GetEntryCount() const
+{
+	return m_File.IsOpen() ? std::atomic_ref<uint64_t>(GetHeader()->m_EntryCount).load(std::memory_order_relaxed) : 0;
+}
+
+PositionDatabase::Entry* PositionDatabase::Find(PackedBoard const& board, TileColor piece, bool bInsert) const
+{
+	if (!m_File.IsOpen())
+	{
+		return nullptr;
+	}
+
+	uint64_t key = PositionKey(board, piece);
+	uint64_t mask = GetHeader()->m_Capacity - 1;
+	Entry* entries = GetEntries();
+
+	for (uint64_t probe = 0; probe <= mask; ++probe)
+	{
+		Entry& entry = entries[(key + probe) & mask];
+		std::atomic_ref<uint64_t> entryKey(entry.m_Key);
+		std::atomic_ref<uint32_t> state(entry.m_State);
+
+		uint64_t existing = entryKey.load(std::memory_order_acquire);
+		if (existing == 0)
+		{
+			if (!bInsert)
+			{
+				return nullptr;
+			}
+			if (entryKey.compare_exchange_strong(existing, key, std::memory_order_acq_rel))
+			{
+				entry.m_Board = board;
+				entry.m_Piece = piece;
+				uint32_t writing = s_EntryWriting;
+				if (state.compare_exchange_strong(writing, s_EntryReady, std::memory_order_acq_rel))
+				{
+					std::atomic_ref<uint64_t>(GetHeader()->m_EntryCount).fetch_add(1, std::memory_order_relaxed);
+					return &entry;
+				}
+				// Another insert took this too long and abandoned the slot
+				continue;
+			}
+			// Lost the race; existing now holds the winner's key
+		}
+
+		if (existing != key)
+		{
+			continue;
+		}
+
+		// Same key: once the claiming thread has published the board, make
+		// sure it isn't a hash collision. Lookups don't wait; a position
+		// still being written isn't there yet.
+		uint32_t entryState = state.load(std::memory_order_acquire);
+		if (entryState == s_EntryWriting && bInsert)
+		{
+			auto deadline = std::chrono::steady_clock::now() + s_ClaimTimeout;
+			while ((entryState = state.load(std::memory_order_acquire)) == s_EntryWriting
+				&& std::chrono::steady_clock::now() < deadline)
+			{
+				std::this_thread::yield();
+			}
+			if (entryState == s_EntryWriting)
+			{
+				state.compare_exchange_strong(entryState, s_EntryAbandoned, std::memory_order_acq_rel);
+			}
+		}
+		if (entryState == s_EntryReady && entry.m_Piece == piece && entry.m_Board == board)
+		{
+			return &entry;
+		}
+	}
+
+	return nullptr;
+}
+
+bool PositionDatabase::Record(PackedBoard const& board, TileColor piece, TetronimoInstance const& placement, int futureScore)
+{
+	return Record(board, piece, placement.GetRotationIndex(), placement.GetPosition().x, placement.GetPosition().y, futureScore);
+}
+
+bool PositionDatabase::Record(DatasetRecord const& record)
+{
+	return Record(record.m_Board, record.m_Piece, record.m_Rotation, record.m_Column, record.m_Row,
+		record.m_FinalScore - record.m_Score);
+}
+
+bool PositionDatabase::Record(PackedBoard const& board, TileColor piece, int rotation, int column, int row, int futureScore)
+{
+	// Colors aren't part of a canonical position, only occupancy
+	Entry* entry = Find(board, piece, true);
+	if (entry == nullptr)
+	{
+		return false;
+	}
+
+	std::atomic_ref<uint64_t>(entry->m_VisitCount).fetch_add(1, std::memory_order_relaxed);
+	std::atomic_ref<int64_t>(entry->m_FutureScoreSum).fetch_add(futureScore, std::memory_order_relaxed);
+
+	uint64_t best = PackBest(futureScore, rotation, column, row);
+	std::atomic_ref<uint64_t> entryBest(entry->m_Best);
+	uint64_t current = entryBest.load(std::memory_order_relaxed);
+	while (current < best && !entryBest.compare_exchange_weak(current, best, std::memory_order_relaxed))
+	{
+	}
+
+	return true;
+}
+
+bool PositionDatabase::Lookup(PackedBoard const& board, TileColor piece, PositionStats& out) const
+{
+	Entry* entry = Find(board, piece, false);
+	if (entry == nullptr)
+	{
+		return false;
+	}
+
+	// Fields are read separately, so a concurrent Record() may be half
+	// reflected; fine for statistics.
+	out = {};
+	out.m_VisitCount = std::atomic_ref<uint64_t>(entry->m_VisitCount).load(std::memory_order_relaxed);
+	int64_t sum = std::atomic_ref<int64_t>(entry->m_FutureScoreSum).load(std::memory_order_relaxed);
+	if (out.m_VisitCount > 0)
+	{
+		out.m_MeanFutureScore = static_cast<double>(sum) / static_cast<double>(out.m_VisitCount);
+	}
+
+	uint64_t best = std::atomic_ref<uint64_t>(entry->m_Best).load(std::memory_order_relaxed);
+	BestPlacement placement{};
+	uint32_t low = static_cast<uint32_t>(best);
+	std::memcpy(&placement, &low, sizeof(placement));
+	out.m_bHasBest = placement.m_bValid != 0;
+	if (out.m_bHasBest)
+	{
+		out.m_BestFutureScore = static_cast<int>(static_cast<uint32_t>(best >> 32) ^ 0x80000000u);
+		out.m_BestRotation = placement.m_Rotation;
+		out.m_BestColumn = placement.m_Column;
+		out.m_BestRow = placement.m_Row;
+	}
+
+	return true;
+}
+
+}
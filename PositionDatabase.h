@@ -0,0 +1,84 @@
+#pragma once
+#ifndef BLOCKDROP_POSITION_DATABASE_H
+#define BLOCKDROP_POSITION_DATABASE_H
+
+#include <string>
+
+#include "Dataset.h"
+#include "MappedFile.h"
+#include "PackedBoard.h"
+
+namespace BlockDrop
+{
+
+// Aggregated statistics for one (board, piece to place) position.
+struct PositionStats
+{
+	uint64_t m_VisitCount{};
+	double m_MeanFutureScore{};
+
+	// Placement that led to the highest future score seen so far
+	bool m_bHasBest{ false };
+	int m_BestFutureScore{};
+	int m_BestRotation{};
+	int m_BestColumn{};
+	int m_BestRow{};
+};
+
+// Persistent open-addressing hash table of positions, memory mapped from a
+// single file. Positions are canonical: only occupancy counts, so boards that
+// differ in tile colors share an entry.
+//
+// Any number of threads (or processes mapping the same file) may Record()
+// and Lookup() concurrently. Entries are claimed with a compare-and-swap on
+// their key and statistics are updated with atomic adds, so nothing locks.
+// A slot whose writer died between claiming and publishing it is skipped by
+// lookups, and given up on by inserts after a bounded wait.
+// Capacity is fixed when the file is created; Record() fails once the table
+// is full.
+class PositionDatabase
+{
+public:
+	static constexpr uint64_t s_DefaultCapacity = uint64_t{ 1 } << 20;
+
+public:
+	PositionDatabase() = default;
+	PositionDatabase(PositionDatabase&) = delete;
+
+	// Opens an existing database or creates an empty one with room for
+	// capacity entries (rounded up to a power of two). Only a missing or
+	// empty file is created; any other file that isn't a whole database is
+	// left untouched and fails.
+	bool Open(std::string const& path, uint64_t capacity = s_DefaultCapacity);
+	void Close();
+	void Flush() const;
+
+	bool Record(PackedBoard const& board, TileColor piece, TetronimoInstance const& placement, int futureScore);
+	// Future score is the record's final score minus its score at placement
+	bool Record(DatasetRecord const& record);
+
+	bool Lookup(PackedBoard const& board, TileColor piece, PositionStats& out) const;
+
+	uint64_t GetCapacity() const;
+	uint64_t GetEntryCount() const;
+
+private:
+	struct Header;
+	struct Entry;
+
+	// Whether a file's bytes start with a header for a table that fits them
+	static bool IsValidHeader(uint8_t const* data, size_t size);
+
+	Header* GetHeader() const;
+	Entry* GetEntries() const;
+
+	Entry* Find(PackedBoard const& board, TileColor piece, bool bInsert) const;
+	bool Record(PackedBoard const& board, TileColor piece, int rotation, int column, int row, int futureScore);
+
+private:
+	MappedFile m_File;
+};
+
+}
+
+#endif
@@ -0,0 +1,159 @@
+#include "Profiler.h"
+
+#if defined(BLOCKDROP_PROFILE)
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace BlockDrop
+{
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+// Written by the owning thread only. Atomic so a trace can read them as they
+// change; relaxed, as ThreadZones::m_Count orders them.
+struct Zone
+{
+	std::atomic<char const*> m_Name{};
+	std::atomic<int64_t> m_Start{};
+	std::atomic<int64_t> m_End{};
+};
+
+struct ThreadZones
+{
+	std::array<Zone, Profiler::s_ZonesPerThread> m_Zones{};
+	// Zones ever recorded; the latest s_ZonesPerThread of them are kept
+	std::atomic<uint64_t> m_Count{};
+	std::atomic<char const*> m_Name{};
+	int m_ThreadIndex{};
+};
+
+// Every thread that has recorded a zone. Kept until exit, so a trace still
+// has threads that have finished.
+struct Registry
+{
+	std::mutex m_Mutex;
+	std::vector<std::unique_ptr<ThreadZones>> m_Threads;
+	int64_t m_StartTime{ Profiler::Now() };
+};
+
+Registry& GetRegistry()
+{
+	static Registry registry;
+	return registry;
+}
+
+ThreadZones& GetThreadZones()
+{
+	thread_local ThreadZones* zones = nullptr;
+	if (zones == nullptr)
+	{
+		auto added = std::make_unique<ThreadZones>();
+		Registry& registry = GetRegistry();
+		std::lock_guard<std::mutex> lock(registry.m_Mutex);
+		added->m_ThreadIndex = static_cast<int>(registry.m_Threads.size());
+		zones = added.get();
+		registry.m_Threads.push_back(std::move(added));
+	}
+	return *zones;
+}
+
+struct ZoneCopy
+{
+	char const* m_Name;
+	int64_t m_Start;
+	int64_t m_End;
+};
+
+}
+
+int64_t Profiler::Now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+void Profiler::Record(char const* name, int64_t start, int64_t end)
+{
+	ThreadZones& zones = GetThreadZones();
+	uint64_t count = zones.m_Count.load(std::memory_order_relaxed);
+	Zone& zone = zones.m_Zones[count % s_ZonesPerThread];
+
+	// Pairs with the fence in WriteChromeTrace(): a reader that sees any of
+	// these stores also sees the count from before them
+	std::atomic_thread_fence(std::memory_order_release);
+	zone.m_Name.store(name, std::memory_order_relaxed);
+	zone.m_Start.store(start, std::memory_order_relaxed);
+	zone.m_End.store(end, std::memory_order_relaxed);
+	zones.m_Count.store(count + 1, std::memory_order_release);
+}
+
+void Profiler::SetThreadName(char const* name)
+{
+	GetThreadZones().m_Name.store(name, std::memory_order_relaxed);
+}
+
+bool Profiler::WriteChromeTrace(std::string const& path)
+{
+	FILE* file = std::fopen(path.c_str(), "w");
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	Registry& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.m_Mutex);
+
+	std::vector<ZoneCopy> copies;
+	char const* separator = "";
+	std::fprintf(file, "{\"traceEvents\":[");
+	for (auto const& thread : registry.m_Threads)
+	{
+		if (char const* name = thread->m_Name.load(std::memory_order_relaxed))
+		{
+			std::fprintf(file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+				separator, thread->m_ThreadIndex, name);
+			separator = ",";
+		}
+
+		uint64_t count = thread->m_Count.load(std::memory_order_acquire);
+		uint64_t first = count > s_ZonesPerThread ? count - s_ZonesPerThread : 0;
+		copies.clear();
+		for (uint64_t i = first; i < count; ++i)
+		{
+			Zone const& zone = thread->m_Zones[i % s_ZonesPerThread];
+			copies.push_back({
+				zone.m_Name.load(std::memory_order_relaxed),
+				zone.m_Start.load(std::memory_order_relaxed),
+				zone.m_End.load(std::memory_order_relaxed) });
+		}
+
+		// Zones the thread has started overwriting since are left out
+		std::atomic_thread_fence(std::memory_order_acquire);
+		uint64_t countAfter = thread->m_Count.load(std::memory_order_relaxed);
+		for (uint64_t i = first; i < count; ++i)
+		{
+			if (i + s_ZonesPerThread <= countAfter)
+			{
+				continue;
+			}
+			ZoneCopy const& zone = copies[i - first];
+			std::fprintf(file, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+				separator, zone.m_Name, thread->m_ThreadIndex,
+				(zone.m_Start - registry.m_StartTime) / 1000.0, (zone.m_End - zone.m_Start) / 1000.0);
+			separator = ",";
+		}
+	}
+	std::fprintf(file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+
+	return std::fclose(file) == 0;
+}
+
+}
+
+#endif
@@ -0,0 +1,84 @@
+#pragma once
+#ifndef BLOCKDROP_PROFILER_H
+#define BLOCKDROP_PROFILER_H
+
+// Scoped timing zones, written out as a Chrome trace (chrome://tracing or
+// ui.perfetto.dev). Only built with BLOCKDROP_PROFILE defined; otherwise the
+// macros below are empty and nothing here is compiled in.
+//
+//   void App::DrawUI()
+//   {
+//       BLOCKDROP_PROFILE_ZONE("DrawUI");
+//       ...
+//   }
+//
+// Zone names must be string literals, or otherwise outlive the trace.
+
+#if defined(BLOCKDROP_PROFILE)
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace BlockDrop
+{
+
+// Each thread records into its own ring of the most recent zones, so
+// recording takes no locks and never allocates after a thread's first zone.
+// A trace can be written from any thread while the others keep recording;
+// zones overwritten while it's being written are left out.
+class Profiler
+{
+public:
+	static constexpr size_t s_ZonesPerThread = 1 << 14;
+
+public:
+	// Nanoseconds on a clock shared by every thread
+	static int64_t Now();
+	static void Record(char const* name, int64_t start, int64_t end);
+	// Shown for the calling thread in the trace
+	static void SetThreadName(char const* name);
+
+	// Every thread's recorded zones as trace_event JSON. Returns false if it
+	// couldn't be written.
+	static bool WriteChromeTrace(std::string const& path);
+};
+
+class ProfileZone
+{
+public:
+	explicit ProfileZone(char const* name)
+		: m_Name(name)
+		, m_Start(Profiler::Now())
+	{
+	}
+	~ProfileZone() { Profiler::Record(m_Name, m_Start, Profiler::Now()); }
+
+	ProfileZone(ProfileZone const&) = delete;
+	ProfileZone& operator=(ProfileZone const&) = delete;
+
+private:
+	char const* m_Name;
+	int64_t m_Start;
+};
+
+}
+
+#define BLOCKDROP_PROFILE_JOIN2(a, b) a##b
+#define BLOCKDROP_PROFILE_JOIN(a, b) BLOCKDROP_PROFILE_JOIN2(a, b)
+#define BLOCKDROP_PROFILE_ZONE(name) ::BlockDrop::ProfileZone BLOCKDROP_PROFILE_JOIN(profileZone, __LINE__)(name)
+#define BLOCKDROP_PROFILE_THREAD(name) ::BlockDrop::Profiler::SetThreadName(name)
+
+#else
+
+#define BLOCKDROP_PROFILE_ZONE(name) ((void)0)
+#define BLOCKDROP_PROFILE_THREAD(name) ((void)0)
+
+#endif
+
+// Zones in olc's frame loop; see olcPixelGameEngine.cpp
+#define OLC_PROFILE_ZONE(name) BLOCKDROP_PROFILE_ZONE(name)
+
+#endif
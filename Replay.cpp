@@ -0,0 +1,165 @@
+#include "Replay.h"
+
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+namespace BlockDrop
+{
+
+bool Replay::Load(std::string const& path)
+{
+	std::ifstream file(path);
+	if (!file)
+	{
+		return false;
+	}
+
+	Replay result{};
+	std::string line;
+	while (std::getline(file, line))
+	{
+		std::istringstream words(line);
+		std::string word;
+		if (!(words >> word) || word[0] == '#')
+		{
+			continue;
+		}
+
+		if (word == "seed")
+		{
+			if (!(words >> result.m_Seed))
+			{
+				return false;
+			}
+			continue;
+		}
+		if (word == "frametime")
+		{
+			if (!(words >> result.m_FrameTime) || result.m_FrameTime <= 0.0f)
+			{
+				return false;
+			}
+			continue;
+		}
+
+		size_t count = 0;
+		try
+		{
+			count = std::stoul(word);
+		}
+		catch (std::exception const&)
+		{
+			return false;
+		}
+
+		ReplayKeys keys = 0;
+		while (words >> word)
+		{
+			size_t key = 0;
+			while (key < s_ReplayKeyNames.size() && word != s_ReplayKeyNames[key])
+			{
+				key++;
+			}
+			if (key == s_ReplayKeyNames.size())
+			{
+				return false;
+			}
+			keys |= static_cast<ReplayKeys>(1 << key);
+		}
+		result.AddFrames(keys, count);
+	}
+
+	*this = std::move(result);
+	return true;
+}
+
+bool Replay::Save(std::string const& path) const
+{
+	std::ofstream file(path);
+	if (!file)
+	{
+		return false;
+	}
+
+	file << "# BlockDrop replay\n";
+	file << "seed " << m_Seed << '\n';
+	// Enough digits to round-trip, or the replay drifts
+	file << "frametime " << std::setprecision(9) << m_FrameTime << '\n';
+
+	// One line per run of identical frames
+	for (size_t frame = 0; frame < m_Frames.size();)
+	{
+		size_t end = frame;
+		while (end < m_Frames.size() && m_Frames[end] == m_Frames[frame])
+		{
+			end++;
+		}
+
+		file << (end - frame);
+		for (size_t key = 0; key < s_ReplayKeyNames.size(); ++key)
+		{
+			if (m_Frames[frame] & (1 << key))
+			{
+				file << ' ' << s_ReplayKeyNames[key];
+			}
+		}
+		file << '\n';
+		frame = end;
+	}
+
+	return static_cast<bool>(file);
+}
+
+Replay Replay::MakeScripted(uint32_t seed, size_t frameCount)
+{
+	Replay result(seed);
+	std::mt19937 random(seed);
+	auto roll = [&](int max) { return std::uniform_int_distribution<int>(0, max)(random); };
+
+	// Taps are one frame down, one frame up so every one registers as a press
+	auto tap = [&](olc::Key key, int count) {
+		for (int i = 0; i < count; ++i)
+		{
+			result.AddFrames(ReplayKeyBit(key));
+			result.AddFrames(0);
+		}
+	};
+
+	while (result.GetFrameCount() < frameCount)
+	{
+		// Give the next piece time to spawn
+		result.AddFrames(0, 6 + roll(10));
+		tap(olc::UP, roll(3));
+		tap(roll(1) == 0 ? olc::LEFT : olc::RIGHT, roll(5));
+		if (roll(3) == 0)
+		{
+			result.AddFrames(ReplayKeyBit(olc::DOWN), 10 + roll(20));
+		}
+		tap(olc::SPACE, 1);
+	}
+
+	result.m_Frames.resize(frameCount);
+	return result;
+}
+
+Input InputFromKeys(ReplayKeys keys, ReplayKeys previousKeys)
+{
+	auto held = [&](olc::Key key) { return (keys & ReplayKeyBit(key)) != 0; };
+	auto pressed = [&](olc::Key key) { return held(key) && (previousKeys & ReplayKeyBit(key)) == 0; };
+
+	Input result = {};
+	result.bLeft = pressed(olc::Key::LEFT);
+	result.bLeftHeld = held(olc::Key::LEFT);
+	result.bRight = pressed(olc::Key::RIGHT);
+	result.bRightHeld = held(olc::Key::RIGHT);
+	result.bRotateLeft = pressed(olc::Key::Q);
+	result.bRotateRight = pressed(olc::Key::E) || pressed(olc::Key::UP);
+	result.bSoftDrop = held(olc::Key::DOWN);
+	result.bHardDrop = pressed(olc::Key::SPACE);
+	return result;
+}
+
+}
@@ -0,0 +1,89 @@
+#pragma once
+#ifndef BLOCKDROP_REPLAY_H
+#define BLOCKDROP_REPLAY_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "olcPixelGameEngine.h"
+
+#include "Sim.h"
+
+namespace BlockDrop
+{
+
+// Keys App reads, in ReplayKeys bit order
+static constexpr std::array<olc::Key, 10> s_ReplayKeys{
+	olc::LEFT, olc::RIGHT, olc::UP, olc::DOWN, olc::SPACE,
+	olc::Q, olc::E, olc::ENTER, olc::ESCAPE, olc::OEM_2,
+};
+static constexpr std::array<char const*, 10> s_ReplayKeyNames{
+	"LEFT", "RIGHT", "UP", "DOWN", "SPACE",
+	"Q", "E", "ENTER", "ESCAPE", "SLASH",
+};
+
+// Keys held during one frame, bit N for s_ReplayKeys[N]
+using ReplayKeys = uint16_t;
+
+constexpr ReplayKeys ReplayKeyBit(olc::Key key)
+{
+	for (size_t i = 0; i < s_ReplayKeys.size(); ++i)
+	{
+		if (s_ReplayKeys[i] == key)
+		{
+			return static_cast<ReplayKeys>(1 << i);
+		}
+	}
+	return 0;
+}
+
+// An input log: the game seed plus the keys held on every frame, played back
+// at a fixed frame time. Stored as text so scripts can be written by hand:
+//
+//   # comment
+//   seed 1234
+//   frametime 0.0166667
+//   30              <- 30 frames, nothing held
+//   1 LEFT          <- 1 frame with LEFT held
+//   2 DOWN SPACE
+class Replay
+{
+public:
+	static constexpr float s_DefaultFrameTime = 1.0f / 60.0f;
+
+public:
+	Replay() = default;
+	explicit Replay(uint32_t seed)
+		: m_Seed(seed)
+	{
+	}
+
+	uint32_t GetSeed() const { return m_Seed; }
+	float GetFrameTime() const { return m_FrameTime; }
+	void SetFrameTime(float frameTime) { m_FrameTime = frameTime; }
+
+	size_t GetFrameCount() const { return m_Frames.size(); }
+	ReplayKeys GetKeys(size_t frame) const { return m_Frames[frame]; }
+	void AddFrames(ReplayKeys keys, size_t count = 1) { m_Frames.insert(m_Frames.end(), count, keys); }
+
+	bool Load(std::string const& path);
+	bool Save(std::string const& path) const;
+
+	// A scripted game: each piece gets a few random rotations and sideways
+	// taps, then a hard drop. Same seed, same game.
+	static Replay MakeScripted(uint32_t seed, size_t frameCount);
+
+private:
+	uint32_t m_Seed{};
+	float m_FrameTime{ s_DefaultFrameTime };
+	std::vector<ReplayKeys> m_Frames;
+};
+
+// What the Sim gets from keys held this frame, sampled once per frame
+Input InputFromKeys(ReplayKeys keys, ReplayKeys previousKeys);
+
+}
+
+#endif
@@ -6,13 +6,16 @@
 
 namespace BlockDrop {
 
-ScoreList FileBackedScoreBoard::ParseScoresFromDisk()
+ScoreList FileBackedScoreBoard::ParseScoresFromDisk(bool bUseFile)
 {
     ScoreList result{};
 
-    std::ifstream scoreFile(s_ScoreFile);
+    std::ifstream scoreFile;
+    if (bUseFile) {
+        scoreFile.open(s_ScoreFile);
+    }
     std::stringstream scores;
-    if (!scoreFile) {
+    if (!scoreFile.is_open()) {
         scores << s_DefaultScores;
     }
     else {
@@ -42,14 +45,17 @@ ScoreList FileBackedScoreBoard::ParseScoresFromDisk()
     return result;
 }
 
-FileBackedScoreBoard::FileBackedScoreBoard()
-    : ScoreBoard(ParseScoresFromDisk())
+FileBackedScoreBoard::FileBackedScoreBoard(bool bUseFile)
+    : ScoreBoard(ParseScoresFromDisk(bUseFile))
+    , m_bUseFile(bUseFile)
 {
 }
 void FileBackedScoreBoard::SetScore(const std::string& name, const int score, const int level)
 {
     ScoreBoard::SetScore(name, score, level);
-    SaveScores();
+    if (m_bUseFile) {
+        SaveScores();
+    }
 }
 
 void FileBackedScoreBoard::SaveScores() {
@@ -34,14 +34,17 @@ private:
 class FileBackedScoreBoard : public ScoreBoard
 {
 public:
-    FileBackedScoreBoard();
+    // Without the file, starts from the default scores and never saves
+    explicit FileBackedScoreBoard(bool bUseFile = true);
     virtual void SetScore(const std::string& name, const int score, const int level) override;
 
 private:
-    static ScoreList ParseScoresFromDisk();
+    static ScoreList ParseScoresFromDisk(bool bUseFile);
     static constexpr char s_ScoreFile[] = "scores.tsv";
     static constexpr char s_DefaultScores[] = "AAA\t100\t1\nBBB\t200\t2\nCCC\t300\t3\nDDD\t400\t4\nEEE\t500\t5\nFFF\t600\t6\nGGG\t700\t7\nHHH\t800\t8\nIII\t900\t9\nJJJ\t1000\t10";
 
+    bool m_bUseFile{ true };
+
 private:
     void SaveScores();
 };
@@ -1,7 +1,9 @@
 #include "Sim.h"
+#include "Profiler.h"
+#include "SimCounters.h"
 
 #include <algorithm>
-#include <set>
+#include <array>
 
 namespace BlockDrop
 {
@@ -15,6 +17,9 @@ bool HasDirection(BorderDirection value, BorderDirection other)
 
 void Sim::Update(float deltaTime, Input const& input)
 {
+	BLOCKDROP_PROFILE_ZONE("Sim::Update");
+	BLOCKDROP_SIM_UPDATE_TIMER();
+
 	if (m_GameOver)
 	{
 		return;
@@ -31,17 +36,29 @@ void Sim::Update(float deltaTime, Input const& input)
 	}
 	if (m_FallingBlock.has_value() && m_LockDelayTimer <= 0.f)
 	{
-		m_DropTimer += deltaTime * GetGravity(input);
+		if (input.bHardDrop && !IsBlockOnGround(m_FallingBlock.value()))
+		{
+			// Enough rows to reach the floor, however short the update
+			m_DropTimer += static_cast<float>(m_Height + 1);
+		}
+		else
+		{
+			m_DropTimer += deltaTime * GetGravity(input);
+		}
 		bool bDropped = m_DropTimer > 1.f;
 		bool bFirstDrop = true;
 		while (m_DropTimer > 1.f && m_FallingBlock.has_value())
 		{
+			BLOCKDROP_SIM_COUNT(GravitySteps);
 			TetronimoInstance copy = m_FallingBlock.value();
 			if (!TryMoveFallingBlock({ 0, 1 }) && bFirstDrop)
 			{
 				// Place the current position blocks as tiles
 				TransferBlockToTiles(m_FallingBlock.value());
+				m_LastPlacedBlock = m_FallingBlock;
+				m_PlacedBlockCount++;
 				m_FallingBlock.reset();
+				MarkFallingBlockChanged();
 				m_NextBlockTimer = s_TetronimoSpawnDelay;
 			}
 
@@ -77,6 +94,7 @@ void Sim::Update(float deltaTime, Input const& input)
 			{
 				m_FallingBlock = std::make_optional<TetronimoInstance>(newBlock);
 				m_DropTimer = 0.f;
+				MarkFallingBlockChanged();
 			}
 		}
 	}
@@ -93,8 +111,13 @@ void Sim::ResetGame()
 
 	m_Tiles.assign(m_Tiles.size(), TileColor::None);
 	m_FallingBlock.reset();
+	m_LastPlacedBlock.reset();
+	m_PlacedBlockCount = 0;
 	m_NextBlocks.clear();
 	m_GameOver = false;
+
+	MarkTilesChanged();
+	MarkFallingBlockChanged();
 }
 
 void Sim::ScoreClearedRows(int rowCount)
@@ -127,20 +150,25 @@ TileColor Sim::GetNextBlockColor()
 {
 	if (m_NextBlocks.empty())
 	{
-		m_NextBlocks = {
-			TileColor::Red,
-			TileColor::Blue,
-			TileColor::Cyan,
-			TileColor::Magenta,
-			TileColor::Yellow,
-			TileColor::Green,
-			TileColor::Orange,
-		};
-		std::shuffle(m_NextBlocks.begin(), m_NextBlocks.end(), m_RandStream);
+		RefillBag(m_NextBlocks);
 	}
 
 	return m_NextBlocks.back();
 }
+void Sim::RefillBag(std::vector<TileColor>& bag)
+{
+	bag = {
+		TileColor::Red,
+		TileColor::Blue,
+		TileColor::Cyan,
+		TileColor::Magenta,
+		TileColor::Yellow,
+		TileColor::Green,
+		TileColor::Orange,
+	};
+	std::shuffle(bag.begin(), bag.end(), m_RandStream);
+	m_BagCount++;
+}
 TileColor Sim::PopNextBlockColor()
 {
 	auto result = GetNextBlockColor();
@@ -189,6 +217,7 @@ bool Sim::TryMoveFallingBlock(olc::vi2d const& delta)
 	if (TryMoveBlock(copy, delta))
 	{
 		m_FallingBlock = copy;
+		MarkFallingBlockChanged();
 		return true;
 	}
 
@@ -208,6 +237,7 @@ bool Sim::TryRotateFallingBlock(int direction)
 	if (TryWallKick(rotated))
 	{
 		m_FallingBlock = rotated;
+		MarkFallingBlockChanged();
 		return true;
 	}
 
@@ -220,12 +250,14 @@ bool Sim::TryWallKick(TetronimoInstance& tetronimo) const
 	{
 		return true;
 	}
+	BLOCKDROP_SIM_COUNT(WallKickAttempts);
 
 	// Wall kick left 1
 	TetronimoInstance copy = tetronimo;
 	copy.Move({ -1, 0 });
 	if (!HasCollision(copy))
 	{
+		BLOCKDROP_SIM_COUNT(WallKicks);
 		tetronimo = copy;
 		return true;
 	}
@@ -235,6 +267,7 @@ bool Sim::TryWallKick(TetronimoInstance& tetronimo) const
 	copy.Move({ 1, 0 });
 	if (!HasCollision(copy))
 	{
+		BLOCKDROP_SIM_COUNT(WallKicks);
 		tetronimo = copy;
 		return true;
 	}
@@ -244,6 +277,7 @@ bool Sim::TryWallKick(TetronimoInstance& tetronimo) const
 	copy.Move({ -2, 0 });
 	if (!HasCollision(copy))
 	{
+		BLOCKDROP_SIM_COUNT(WallKicks);
 		tetronimo = copy;
 		return true;
 	}
@@ -253,6 +287,7 @@ bool Sim::TryWallKick(TetronimoInstance& tetronimo) const
 	copy.Move({ 2, 0 });
 	if (!HasCollision(copy))
 	{
+		BLOCKDROP_SIM_COUNT(WallKicks);
 		tetronimo = copy;
 		return true;
 	}
@@ -262,7 +297,12 @@ bool Sim::TryWallKick(TetronimoInstance& tetronimo) const
 
 void Sim::TransferBlockToTiles(TetronimoInstance const& tetronimo)
 {
-	std::set<int> changedRows{};
+	BLOCKDROP_SIM_COUNT(Locks);
+
+	// A tetronimo covers at most four rows; kept off the heap as this runs
+	// on every lock
+	std::array<int, 4> changedRows{};
+	int changedRowCount = 0;
 
 	auto tetronimoPosition = tetronimo.GetPosition();
 	for (auto const& square : tetronimo.GetSquares())
@@ -274,45 +314,66 @@ void Sim::TransferBlockToTiles(TetronimoInstance const& tetronimo)
 		{
 			continue;
 		}
-		changedRows.insert(row);
+		// Insert in order, top row first, skipping rows already seen
+		int insertAt = 0;
+		while (insertAt < changedRowCount && changedRows[insertAt] < row)
+		{
+			++insertAt;
+		}
+		if (insertAt == changedRowCount || changedRows[insertAt] != row)
+		{
+			assert(changedRowCount < static_cast<int>(changedRows.size()));
+			for (int i = changedRowCount; i > insertAt; --i)
+			{
+				changedRows[i] = changedRows[i - 1];
+			}
+			changedRows[insertAt] = row;
+			++changedRowCount;
+		}
 		if (_At(row, col) == TileColor::None)
 		{
 			_At(row, col) = tetronimo.GetTileColor();
 		}
 	}
+	if (changedRowCount > 0)
+	{
+		MarkTilesChanged();
+	}
 
-	std::vector<int> clearedRows{};
-	for (int row : changedRows)
+	std::array<int, 4> clearedRows{};
+	int clearedRowCount = 0;
+	for (int i = 0; i < changedRowCount; ++i)
 	{
-		if (RowFilled(row))
+		if (RowFilled(changedRows[i]))
 		{
-			clearedRows.push_back(row);
+			clearedRows[clearedRowCount++] = changedRows[i];
 		}
 	}
 
-	if (clearedRows.empty())
+	if (clearedRowCount == 0)
 	{
 		// No rows cleared
 		m_Combo = -1;
 		return;
 	}
 
+	BLOCKDROP_SIM_COUNT_CLEARS(clearedRowCount);
 	m_Combo++;
-	ScoreClearedRows(static_cast<int>(clearedRows.size()));
+	ScoreClearedRows(clearedRowCount);
 
 	// Move the blocks down
-	int dest = clearedRows.back();
-	clearedRows.pop_back();
+	int dest = clearedRows[clearedRowCount - 1];
+	clearedRowCount--;
 	int src = dest - 1;
 
 	// Move tiles from the top to the bottom
 	while (dest >= 0)
 	{
 		// If the row we're pulling from was cleared, skip over it as a source
-		while (!clearedRows.empty() && clearedRows.back() == src)
+		while (clearedRowCount > 0 && clearedRows[clearedRowCount - 1] == src)
 		{
 			src--;
-			clearedRows.pop_back();
+			clearedRowCount--;
 		}
 
 		for (int col = 0; col < m_Width; ++col)
@@ -345,11 +406,6 @@ bool Sim::RowFilled(int row) const
 
 float Sim::GetGravity(Input const& input)
 {
-	if (input.bHardDrop && m_FallingBlock.has_value() && !IsBlockOnGround(m_FallingBlock.value()))
-	{
-		return 1200.f;
-	}
-
 	float gravity = m_GravityByLevel[std::min(static_cast<int>(m_GravityByLevel.size()), m_Level)];
 	if (input.bSoftDrop && m_FallingBlock.has_value() && !IsBlockOnGround(m_FallingBlock.value()))
 	{
@@ -403,6 +459,8 @@ float Sim::HandleInput(Input const& input)
 
 bool Sim::HasCollision(TetronimoInstance const& tetronimo) const
 {
+	BLOCKDROP_SIM_COUNT(HasCollision);
+
 	auto tetronimoPosition = tetronimo.GetPosition();
 	for (auto const& square : tetronimo.GetSquares())
 	{
@@ -2,7 +2,9 @@
 #ifndef BLOCKDROP_SIM_H
 #define BLOCKDROP_SIM_H
 
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <optional>
 #include <random>
 #include <vector>
@@ -22,7 +24,9 @@ struct Input {
 	bool bRotateRight;
 };
 
-enum class TileColor
+// Stored once per board cell, so keep it to a byte: a 10x20 board is 200 bytes
+// of tiles instead of 800. See PackedBoard.h for denser storage.
+enum class TileColor : unsigned char
 {
 	None,
 
@@ -119,6 +123,14 @@ public:
 	{
 		return m_Tetronimo->m_CenterOffset;
 	}
+	int GetRotationIndex() const
+	{
+		return m_RotationIndex;
+	}
+	int GetRotationCount() const
+	{
+		return static_cast<int>(m_Tetronimo->m_RotatedTileOffsets.size());
+	}
 	void SetPosition(olc::vi2d const& position)
 	{
 		m_Position = position;
@@ -130,9 +142,14 @@ public:
 
 	void Rotate(int direction)
 	{
-		const int size = static_cast<int>(m_Tetronimo->m_RotatedTileOffsets.size());
+		const int size = GetRotationCount();
 		m_RotationIndex = (m_RotationIndex + size + direction) % size;
 	}
+	void SetRotationIndex(int rotationIndex)
+	{
+		assert(rotationIndex >= 0 && rotationIndex < GetRotationCount());
+		m_RotationIndex = rotationIndex;
+	}
 
 private:
 	Tetronimo* m_Tetronimo;
@@ -245,6 +262,19 @@ private:
 
 class Sim
 {
+public:
+	// What changed since the last ClearChanges, so renderers only rebuild
+	// the board when something moved
+	struct Changes
+	{
+		// Placed, cleared, reset or loaded
+		bool m_bTiles{ false };
+		// Moved, rotated, spawned, placed or removed
+		bool m_bFallingBlock{ false };
+
+		bool HasAny() const { return m_bTiles || m_bFallingBlock; }
+	};
+
 public:
 	// Timings
 	static constexpr float s_RotateAirTimeSec = 0.1f;
@@ -258,10 +288,16 @@ public:
 
 public:
 	Sim(int width, int height)
+		: Sim(width, height, std::random_device()())
+	{
+	}
+
+	Sim(int width, int height, uint32_t seed)
 		: m_Width(width)
 		, m_Height(height)
 		, m_Tiles(width * height)
-		, m_RandStream(std::random_device()())
+		, m_Seed(seed)
+		, m_RandStream(seed)
 	{
 		ResetGame();
 	}
@@ -275,6 +311,9 @@ public:
 		return m_Tiles;
 	}
 
+	int GetWidth() const { return m_Width; }
+	int GetHeight() const { return m_Height; }
+
 	TileColor At(int row, int col) const
 	{
 		assert(IsValidPosition(row, col));
@@ -282,7 +321,7 @@ public:
 		return m_Tiles[row * m_Width + col];
 	}
 
-	std::optional<TetronimoInstance> const& GetFallingBlock() { return m_FallingBlock; }
+	std::optional<TetronimoInstance> const& GetFallingBlock() const { return m_FallingBlock; }
 
 	TileColor GetNextBlockColor();
 	TileColor PopNextBlockColor();
@@ -291,12 +330,31 @@ public:
 
 	void Update(float deltaTime, Input const& input);
 	void ResetGame();
+	// Time until a held left or right next moves the falling block
+	float GetInputRepeatTime() const { return m_InputTimer; }
+
+	Changes const& GetChanges() const { return m_Changes; }
+	void ClearChanges() { m_Changes = {}; }
 
 	int GetLevel() const { return m_Level; }
 	int GetScore() const { return m_Score; }
 	bool IsGameOver() const { return m_GameOver; }
+	// Blocks locked into the tiles since the game started or was loaded, and
+	// where the last one went, for recording placements (see Dataset.h)
+	int GetPlacedBlockCount() const { return m_PlacedBlockCount; }
+	std::optional<TetronimoInstance> const& GetLastPlacedBlock() const { return m_LastPlacedBlock; }
+
+	// Versioned, bit-packed snapshot of the full game state. See SimState.cpp
+	// for the layout.
+	std::vector<uint8_t> SaveState() const;
+	// Returns false (leaving the sim untouched) if the data is from another
+	// version or a board of a different size.
+	bool LoadState(std::vector<uint8_t> const& data);
 
 private:
+	// Times the private hot paths; see tools/BenchmarkSuite.cpp
+	friend class SimBenchmark;
+
 	TileColor RandomColor();
 
 	bool IsValidPosition(int row, int col) const
@@ -311,6 +369,17 @@ private:
 		return m_Tiles[row * m_Width + col];
 	}
 
+	void RefillBag(std::vector<TileColor>& bag);
+
+	void MarkTilesChanged()
+	{
+		m_Changes.m_bTiles = true;
+	}
+	void MarkFallingBlockChanged()
+	{
+		m_Changes.m_bFallingBlock = true;
+	}
+
 	float GetGravity(Input const& input);
 
 	float HandleInput(Input const& input);
@@ -353,8 +422,15 @@ private:
 	float m_InputTimer{};
 	std::vector<TileColor> m_Tiles{};
 	std::optional<TetronimoInstance> m_FallingBlock{};
+	std::optional<TetronimoInstance> m_LastPlacedBlock{};
+	int m_PlacedBlockCount{};
 	std::vector<TileColor> m_NextBlocks{};
+	Changes m_Changes{};
 
+	// The RNG is only used to shuffle bags, so its state is fully described by
+	// the seed and the number of bags shuffled so far.
+	uint32_t m_Seed{};
+	uint32_t m_BagCount{};
 	std::mt19937 m_RandStream;
 
 	// Constants
@@ -0,0 +1,125 @@
+#include "SimCounters.h"
+
+#if defined(BLOCKDROP_SIM_COUNTERS)
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace BlockDrop
+{
+
+namespace
+{
+
+constexpr size_t s_CounterCount = static_cast<size_t>(SimCounter::Count);
+
+constexpr std::array<char const*, s_CounterCount> s_CounterNames{
+	"updates", "update ns", "collision tests", "wall kick attempts", "wall kicks",
+	"gravity steps", "locks", "single clears", "double clears", "triple clears", "quad clears",
+};
+
+// Written by the owning thread only, so a relaxed load and store replace a
+// read-modify-write. Atomic so Read() can sum them as they change.
+struct alignas(64) Shard
+{
+	std::array<std::atomic<uint64_t>, s_CounterCount> m_Counts{};
+};
+
+struct Registry
+{
+	std::mutex m_Mutex;
+	std::vector<std::unique_ptr<Shard>> m_Shards;
+};
+
+Registry& GetRegistry()
+{
+	static Registry registry;
+	return registry;
+}
+
+Shard& GetShard()
+{
+	thread_local Shard* shard = nullptr;
+	if (shard == nullptr)
+	{
+		auto added = std::make_unique<Shard>();
+		Registry& registry = GetRegistry();
+		std::lock_guard<std::mutex> lock(registry.m_Mutex);
+		shard = added.get();
+		registry.m_Shards.push_back(std::move(added));
+	}
+	return *shard;
+}
+
+}
+
+SimCounterTotals SimCounterTotals::operator-(SimCounterTotals const& other) const
+{
+	SimCounterTotals result;
+	for (size_t i = 0; i < s_CounterCount; ++i)
+	{
+		result.m_Values[i] = m_Values[i] - other.m_Values[i];
+	}
+	return result;
+}
+
+double SimCounterTotals::GetPerUpdate(SimCounter counter) const
+{
+	uint64_t updates = (*this)[SimCounter::Updates];
+	return updates == 0 ? 0.0 : static_cast<double>((*this)[counter]) / updates;
+}
+
+void SimCounterTotals::Print(FILE* file) const
+{
+	for (size_t i = 0; i < s_CounterCount; ++i)
+	{
+		auto counter = static_cast<SimCounter>(i);
+		std::fprintf(file, "  %-18s %12llu", s_CounterNames[i], static_cast<unsigned long long>(m_Values[i]));
+		if (counter != SimCounter::Updates)
+		{
+			std::fprintf(file, "  (%.3f per update)", GetPerUpdate(counter));
+		}
+		std::fprintf(file, "\n");
+	}
+}
+
+void SimCounters::Add(SimCounter counter, uint64_t count)
+{
+	auto& value = GetShard().m_Counts[static_cast<size_t>(counter)];
+	value.store(value.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+}
+
+SimCounter SimCounters::GetClearsCounter(int rowCount)
+{
+	int index = static_cast<int>(SimCounter::Clears1) + std::clamp(rowCount, 1, 4) - 1;
+	return static_cast<SimCounter>(index);
+}
+
+SimCounterTotals SimCounters::Read()
+{
+	SimCounterTotals totals;
+	Registry& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.m_Mutex);
+	for (auto const& shard : registry.m_Shards)
+	{
+		for (size_t i = 0; i < s_CounterCount; ++i)
+		{
+			totals.m_Values[i] += shard->m_Counts[i].load(std::memory_order_relaxed);
+		}
+	}
+	return totals;
+}
+
+int64_t SimCounters::Now()
+{
+	using Clock = std::chrono::steady_clock;
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+}
+
+#endif
@@ -0,0 +1,105 @@
+#pragma once
+#ifndef BLOCKDROP_SIM_COUNTERS_H
+#define BLOCKDROP_SIM_COUNTERS_H
+
+// Counts of what Sim does on its hot paths: collision tests, wall kicks,
+// gravity steps, locks and line clears, and the time each Update takes. Only
+// built with BLOCKDROP_SIM_COUNTERS defined; otherwise the macros below are
+// empty and nothing here is compiled in.
+//
+//   SimCounterTotals before = SimCounters::Read();
+//   ... run games, on any threads ...
+//   SimCounterTotals totals = SimCounters::Read() - before;
+
+#if defined(BLOCKDROP_SIM_COUNTERS)
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+
+namespace BlockDrop
+{
+
+enum class SimCounter
+{
+	Updates,
+	UpdateNanoseconds,
+	HasCollision,
+	// TryWallKick with the rotated block blocked, and those that found room
+	WallKickAttempts,
+	WallKicks,
+	// Rows the drop timer moved through, by gravity or a drop
+	GravitySteps,
+	// Blocks placed as tiles, including one that tops out
+	Locks,
+	// Locks that cleared 1, 2, 3 and 4 lines
+	Clears1,
+	Clears2,
+	Clears3,
+	Clears4,
+	Count,
+};
+
+struct SimCounterTotals
+{
+	std::array<uint64_t, static_cast<size_t>(SimCounter::Count)> m_Values{};
+
+	uint64_t operator[](SimCounter counter) const { return m_Values[static_cast<size_t>(counter)]; }
+	SimCounterTotals operator-(SimCounterTotals const& other) const;
+
+	double GetPerUpdate(SimCounter counter) const;
+	// One line per counter, with per-Update averages
+	void Print(FILE* file) const;
+};
+
+// Each thread counts into its own shard, so counting takes no locks and
+// shares no cache lines; Read() sums the shards. Shards are kept after their
+// thread exits, so totals include finished threads.
+class SimCounters
+{
+public:
+	static void Add(SimCounter counter, uint64_t count = 1);
+	// Clears1 to Clears4 for a lock that cleared rowCount lines
+	static SimCounter GetClearsCounter(int rowCount);
+	// Every thread's counts so far. Counts made while reading may be missed,
+	// but are never torn.
+	static SimCounterTotals Read();
+	static int64_t Now();
+};
+
+// Counts an Update and the nanoseconds until it returns
+class SimUpdateTimer
+{
+public:
+	SimUpdateTimer()
+		: m_Start(SimCounters::Now())
+	{
+	}
+	~SimUpdateTimer()
+	{
+		SimCounters::Add(SimCounter::Updates);
+		SimCounters::Add(SimCounter::UpdateNanoseconds, static_cast<uint64_t>(SimCounters::Now() - m_Start));
+	}
+
+	SimUpdateTimer(SimUpdateTimer const&) = delete;
+	SimUpdateTimer& operator=(SimUpdateTimer const&) = delete;
+
+private:
+	int64_t m_Start;
+};
+
+}
+
+#define BLOCKDROP_SIM_COUNT(counter) ::BlockDrop::SimCounters::Add(::BlockDrop::SimCounter::counter)
+#define BLOCKDROP_SIM_COUNT_CLEARS(rowCount) ::BlockDrop::SimCounters::Add(::BlockDrop::SimCounters::GetClearsCounter(rowCount))
+#define BLOCKDROP_SIM_UPDATE_TIMER() ::BlockDrop::SimUpdateTimer simUpdateTimer
+
+#else
+
+#define BLOCKDROP_SIM_COUNT(counter) ((void)0)
+#define BLOCKDROP_SIM_COUNT_CLEARS(rowCount) ((void)0)
+#define BLOCKDROP_SIM_UPDATE_TIMER() ((void)0)
+
+#endif
+
+#endif
@@ -0,0 +1,67 @@
+#pragma once
+#ifndef BLOCKDROP_SIM_SNAPSHOT_H
+#define BLOCKDROP_SIM_SNAPSHOT_H
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "olcPixelGameEngine.h"
+
+#include "Sim.h"
+
+namespace BlockDrop
+{
+
+// What drawing needs from a Sim, copied out so it can be read while the Sim
+// carries on elsewhere
+struct SimSnapshot
+{
+	int m_Width{};
+	int m_Height{};
+	std::vector<TileColor> m_Tiles;
+	std::optional<TetronimoInstance> m_FallingBlock{};
+	// Before the last step, to interpolate from
+	std::optional<TetronimoInstance> m_PreviousFallingBlock{};
+	olc::vi2d m_DropPosition{ -1, -1 };
+	TileColor m_NextBlockColor{};
+	int m_Level{};
+	int m_Score{};
+	bool m_bGameOver{};
+
+	// Changes whenever the tiles or falling block do
+	uint64_t m_BoardVersion{};
+	// Resets done before this snapshot, to tell a finished game from the next
+	uint32_t m_GameIndex{};
+	// When the last step was taken, on the clock of whatever steps the Sim
+	double m_StepTime{};
+	// Id of the last InputEvent applied
+	uint32_t m_InputId{};
+	// Seconds the last step took to run
+	double m_StepDuration{};
+
+	int GetWidth() const { return m_Width; }
+	int GetHeight() const { return m_Height; }
+	TileColor At(int row, int col) const { return m_Tiles[row * m_Width + col]; }
+	std::optional<TetronimoInstance> const& GetFallingBlock() const { return m_FallingBlock; }
+	olc::vi2d GetDropPosition() const { return m_DropPosition; }
+
+	// Copies the board and score. Reuses the tile storage, so it doesn't
+	// allocate after the first time. Leaves the bookkeeping fields alone.
+	void Capture(Sim& sim)
+	{
+		m_Width = sim.GetWidth();
+		m_Height = sim.GetHeight();
+		m_Tiles.assign(sim.Tiles().begin(), sim.Tiles().end());
+		m_FallingBlock = sim.GetFallingBlock();
+		m_DropPosition = sim.GetDropPosition();
+		m_NextBlockColor = sim.GetNextBlockColor();
+		m_Level = sim.GetLevel();
+		m_Score = sim.GetScore();
+		m_bGameOver = sim.IsGameOver();
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,264 @@
+#include "SimState.h"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <iterator>
+
+#include "BitStream.h"
+
+namespace BlockDrop
+{
+
+// Layout, LSB-first (see BitStream.h):
+//   8   version
+//   6+6 board width, height
+//   1   game over
+//   32  RNG seed, varint bags shuffled so far
+//   3   bag pieces remaining (k), then the remaining pieces as a k-of-7
+//       permutation index in BitsFor(7!/(7-k)! - 1) bits
+//   varint score, rows cleared, combo + 1 (level is derived from rows cleared)
+//   4x32 lock delay, next block, drop and input timers
+//   1   has falling block, then 3 piece id, 2 rotation, column and row
+//   w*h occupancy bits, then 3 bits of color for each occupied cell
+//
+// A typical mid-game 10x20 position comes to 40-80 bytes.
+static constexpr uint32_t s_StateVersion = 1;
+
+static constexpr int s_PieceCount = 7;
+static constexpr int s_PieceIdBits = BitsFor(s_PieceCount - 1);
+static constexpr int s_RotationBits = 2;
+static constexpr int s_DimensionBits = 6;
+// Falling block positions can sit a little outside the board
+static constexpr int s_PositionMargin = 4;
+
+static int PieceId(TileColor color)
+{
+	return static_cast<int>(color) - static_cast<int>(TileColor::Red);
+}
+
+static TileColor PieceColor(int id)
+{
+	return static_cast<TileColor>(id + static_cast<int>(TileColor::Red));
+}
+
+// Number of ordered ways to pick k of the 7 pieces
+static uint32_t PartialPermutationCount(int k)
+{
+	uint32_t count = 1;
+	for (int i = 0; i < k; ++i)
+	{
+		count *= s_PieceCount - i;
+	}
+	return count;
+}
+
+std::vector<uint8_t> Sim::SaveState() const
+{
+	std::vector<uint8_t> data;
+	BitWriter writer(data);
+
+	writer.Write(s_StateVersion, 8);
+	writer.Write(m_Width, s_DimensionBits);
+	writer.Write(m_Height, s_DimensionBits);
+	writer.WriteBool(m_GameOver);
+
+	writer.Write(m_Seed, 32);
+	writer.WriteVarUInt(m_BagCount);
+
+	// Remaining bag as a Lehmer code over the pieces not yet used
+	int remaining = static_cast<int>(m_NextBlocks.size());
+	writer.Write(remaining, 3);
+	std::vector<int> available{ 0, 1, 2, 3, 4, 5, 6 };
+	uint32_t permutationIndex = 0;
+	for (int i = 0; i < remaining; ++i)
+	{
+		auto it = std::find(available.begin(), available.end(), PieceId(m_NextBlocks[i]));
+		assert(it != available.end());
+		permutationIndex = permutationIndex * (s_PieceCount - i) + static_cast<uint32_t>(std::distance(available.begin(), it));
+		available.erase(it);
+	}
+	writer.Write(permutationIndex, BitsFor(PartialPermutationCount(remaining) - 1));
+
+	writer.WriteVarUInt(m_Score);
+	writer.WriteVarUInt(m_RowsCleared);
+	writer.WriteVarUInt(m_Combo + 1);
+
+	writer.WriteFloat(m_LockDelayTimer);
+	writer.WriteFloat(m_NextBlockTimer);
+	writer.WriteFloat(m_DropTimer);
+	writer.WriteFloat(m_InputTimer);
+
+	writer.WriteBool(m_FallingBlock.has_value());
+	if (m_FallingBlock.has_value())
+	{
+		auto const& block = m_FallingBlock.value();
+		writer.Write(PieceId(block.GetTileColor()), s_PieceIdBits);
+		writer.Write(block.GetRotationIndex(), s_RotationBits);
+		writer.Write(block.GetPosition().x + s_PositionMargin, BitsFor(m_Width + 2 * s_PositionMargin));
+		writer.Write(block.GetPosition().y + s_PositionMargin, BitsFor(m_Height + 2 * s_PositionMargin));
+	}
+
+	for (TileColor tile : m_Tiles)
+	{
+		writer.WriteBool(tile != TileColor::None);
+	}
+	for (TileColor tile : m_Tiles)
+	{
+		if (tile != TileColor::None)
+		{
+			writer.Write(PieceId(tile), s_PieceIdBits);
+		}
+	}
+
+	return data;
+}
+
+bool Sim::LoadState(std::vector<uint8_t> const& data)
+{
+	BitReader reader(data);
+
+	if (reader.Read(8) != s_StateVersion
+		|| static_cast<int>(reader.Read(s_DimensionBits)) != m_Width
+		|| static_cast<int>(reader.Read(s_DimensionBits)) != m_Height)
+	{
+		return false;
+	}
+
+	bool bGameOver = reader.ReadBool();
+	uint32_t seed = reader.Read(32);
+	uint32_t bagCount = reader.ReadVarUInt();
+
+	int remaining = static_cast<int>(reader.Read(3));
+	if (remaining > s_PieceCount)
+	{
+		return false;
+	}
+	uint32_t permutationIndex = reader.Read(BitsFor(PartialPermutationCount(remaining) - 1));
+	if (permutationIndex >= PartialPermutationCount(remaining))
+	{
+		return false;
+	}
+	std::array<int, s_PieceCount> digits{};
+	for (int i = remaining - 1; i >= 0; --i)
+	{
+		digits[i] = permutationIndex % (s_PieceCount - i);
+		permutationIndex /= s_PieceCount - i;
+	}
+	std::vector<int> available{ 0, 1, 2, 3, 4, 5, 6 };
+	std::vector<TileColor> nextBlocks;
+	for (int i = 0; i < remaining; ++i)
+	{
+		nextBlocks.push_back(PieceColor(available[digits[i]]));
+		available.erase(available.begin() + digits[i]);
+	}
+
+	int score = static_cast<int>(reader.ReadVarUInt());
+	int rowsCleared = static_cast<int>(reader.ReadVarUInt());
+	int combo = static_cast<int>(reader.ReadVarUInt()) - 1;
+
+	float lockDelayTimer = reader.ReadFloat();
+	float nextBlockTimer = reader.ReadFloat();
+	float dropTimer = reader.ReadFloat();
+	float inputTimer = reader.ReadFloat();
+
+	std::optional<TetronimoInstance> fallingBlock{};
+	if (reader.ReadBool())
+	{
+		int pieceId = static_cast<int>(reader.Read(s_PieceIdBits));
+		int rotation = static_cast<int>(reader.Read(s_RotationBits));
+		int col = static_cast<int>(reader.Read(BitsFor(m_Width + 2 * s_PositionMargin))) - s_PositionMargin;
+		int row = static_cast<int>(reader.Read(BitsFor(m_Height + 2 * s_PositionMargin))) - s_PositionMargin;
+		if (pieceId >= s_PieceCount)
+		{
+			return false;
+		}
+		TetronimoInstance block = TetronimoFactory::New(row, col, PieceColor(pieceId));
+		if (rotation >= block.GetRotationCount())
+		{
+			return false;
+		}
+		block.SetRotationIndex(rotation);
+		fallingBlock = block;
+	}
+
+	std::vector<TileColor> tiles(m_Tiles.size(), TileColor::None);
+	for (TileColor& tile : tiles)
+	{
+		// Mark occupied cells, colors follow once the whole grid is known
+		tile = reader.ReadBool() ? TileColor::Red : TileColor::None;
+	}
+	for (TileColor& tile : tiles)
+	{
+		if (tile != TileColor::None)
+		{
+			int pieceId = static_cast<int>(reader.Read(s_PieceIdBits));
+			if (pieceId >= s_PieceCount)
+			{
+				return false;
+			}
+			tile = PieceColor(pieceId);
+		}
+	}
+
+	if (reader.IsOverrun())
+	{
+		return false;
+	}
+
+	m_GameOver = bGameOver;
+	m_Score = score;
+	m_RowsCleared = rowsCleared;
+	m_Level = 1 + (m_RowsCleared / s_RowsPerLevelUp);
+	m_Combo = combo;
+	m_LockDelayTimer = lockDelayTimer;
+	m_NextBlockTimer = nextBlockTimer;
+	m_DropTimer = dropTimer;
+	m_InputTimer = inputTimer;
+	m_FallingBlock = fallingBlock;
+	m_LastPlacedBlock.reset();
+	m_PlacedBlockCount = 0;
+	m_Tiles = std::move(tiles);
+	MarkTilesChanged();
+	MarkFallingBlockChanged();
+
+	// Bring the RNG back to where it was by replaying the bag shuffles
+	m_Seed = seed;
+	m_RandStream.seed(seed);
+	m_BagCount = 0;
+	std::vector<TileColor> replayBag;
+	while (m_BagCount < bagCount)
+	{
+		RefillBag(replayBag);
+	}
+	m_NextBlocks = std::move(nextBlocks);
+
+	return true;
+}
+
+bool SaveSimToFile(Sim const& sim, std::string const& path)
+{
+	std::ofstream file(path, std::ios::binary);
+	if (!file)
+	{
+		return false;
+	}
+
+	auto data = sim.SaveState();
+	file.write(reinterpret_cast<char const*>(data.data()), data.size());
+	return static_cast<bool>(file);
+}
+
+bool LoadSimFromFile(Sim& sim, std::string const& path)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+	{
+		return false;
+	}
+
+	std::vector<uint8_t> data{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+	return sim.LoadState(data);
+}
+
+}
@@ -0,0 +1,19 @@
+#pragma once
+#ifndef BLOCKDROP_SIM_STATE_H
+#define BLOCKDROP_SIM_STATE_H
+
+#include <string>
+
+#include "Sim.h"
+
+namespace BlockDrop
+{
+
+// Sim::SaveState() written to / read from disk. Used by the app to resume a
+// game after exiting, and by headless tools to checkpoint long runs.
+bool SaveSimToFile(Sim const& sim, std::string const& path);
+bool LoadSimFromFile(Sim& sim, std::string const& path);
+
+}
+
+#endif
@@ -0,0 +1,253 @@
+#include "SimThread.h"
+
+#include "Profiler.h"
+
+namespace BlockDrop
+{
+
+namespace
+{
+
+uint32_t ActionBit(InputAction action)
+{
+	return 1u << static_cast<uint32_t>(action);
+}
+
+}
+
+void SimThread::Start(bool bThreaded)
+{
+	m_bThreaded = bThreaded;
+	m_StartTime = Clock::now();
+	m_StepTime = GetTime();
+	m_bStarted.store(true, std::memory_order_release);
+	Publish();
+
+	if (bThreaded)
+	{
+		m_bStopping.store(false, std::memory_order_relaxed);
+		m_Thread = std::thread([this] { Run(); });
+	}
+}
+
+void SimThread::Stop()
+{
+	if (m_Thread.joinable())
+	{
+		m_bStopping.store(true, std::memory_order_release);
+		m_Thread.join();
+	}
+}
+
+void SimThread::PushInput(InputAction action, bool bDown)
+{
+	if (m_bStarted.load(std::memory_order_acquire))
+	{
+		m_InputEvents.Push({ GetTime(), ++m_LastPushedInputId, action, bDown });
+	}
+}
+
+bool SimThread::TakeShownInput(SimSnapshot const& snapshot, InputEvent& event)
+{
+	InputEvent const* stepped = m_SteppedInputs.Front();
+	// Ids wrap, so compare their difference
+	if (stepped == nullptr || static_cast<int32_t>(stepped->m_Id - snapshot.m_InputId) > 0)
+	{
+		return false;
+	}
+	event = *stepped;
+	m_SteppedInputs.Pop();
+	return true;
+}
+
+void SimThread::Advance(float elapsedTime)
+{
+	m_ManualTime += elapsedTime;
+	Tick(m_ManualTime);
+}
+
+double SimThread::GetTime() const
+{
+	if (m_bThreaded)
+	{
+		return std::chrono::duration<double>(Clock::now() - m_StartTime).count();
+	}
+	return m_ManualTime;
+}
+
+void SimThread::Run()
+{
+	BLOCKDROP_PROFILE_THREAD("Sim");
+
+	while (!m_bStopping.load(std::memory_order_acquire))
+	{
+		Tick(GetTime());
+
+		// Wake when the next step is due; while paused that's a step from now
+		auto wakeTime = m_StartTime + std::chrono::duration_cast<Clock::duration>(
+			std::chrono::duration<double>(m_StepTime + s_StepSec));
+		std::this_thread::sleep_until(wakeTime);
+	}
+}
+
+void SimThread::Tick(double now)
+{
+	bool bChanged = false;
+
+	uint32_t resetRequests = m_ResetRequests.load(std::memory_order_acquire);
+	if (resetRequests != m_GameIndex)
+	{
+		m_Sim.ResetGame();
+		m_GameIndex = resetRequests;
+		m_PreviousFallingBlock.reset();
+		bChanged = true;
+	}
+
+	if (!m_bRunning.load(std::memory_order_relaxed))
+	{
+		SkipInput(now);
+		m_StepTime = now;
+	}
+	else
+	{
+		Clock::time_point stepsStart = Clock::now();
+		int steps = 0;
+		for (; steps < s_MaxStepsPerTick && m_StepTime + s_StepSec <= now; ++steps)
+		{
+			Step();
+			m_StepTime += s_StepSec;
+			bChanged = true;
+		}
+		if (steps > 0)
+		{
+			m_StepDuration = std::chrono::duration<double>(Clock::now() - stepsStart).count() / steps;
+		}
+		if (m_StepTime + s_StepSec <= now)
+		{
+			m_StepTime = now;
+		}
+	}
+
+	if (bChanged)
+	{
+		Publish();
+	}
+}
+
+void SimThread::Step()
+{
+	BLOCKDROP_PROFILE_ZONE("SimThread::Step");
+
+	m_PreviousFallingBlock = m_Sim.GetFallingBlock();
+
+	// Run up to each event due in this step, then apply it. Events from
+	// before the step, like those sent at the start of a frame, apply at
+	// its start.
+	double stepEnd = m_StepTime + s_StepSec;
+	float stepped = 0.f;
+	while (InputEvent const* event = m_InputEvents.Front())
+	{
+		if (event->m_Time >= stepEnd)
+		{
+			break;
+		}
+		float eventTime = static_cast<float>(event->m_Time - m_StepTime);
+		if (eventTime > stepped)
+		{
+			Simulate(eventTime - stepped);
+			stepped = eventTime;
+		}
+		ApplyInput(*event);
+		if (event->m_bDown)
+		{
+			m_SteppedInputs.Push(*event);
+		}
+		m_InputEvents.Pop();
+	}
+	Simulate(s_StepSec - stepped);
+}
+
+void SimThread::Simulate(float deltaTime)
+{
+	uint32_t keys = m_HeldActions | m_PressedActions;
+	auto held = [&](InputAction action) { return (m_HeldActions & ActionBit(action)) != 0; };
+	auto pressed = [&](InputAction action) { return (m_PressedActions & ActionBit(action)) != 0; };
+
+	Input input = {};
+	input.bLeft = pressed(InputAction::Left);
+	input.bLeftHeld = held(InputAction::Left);
+	input.bRight = pressed(InputAction::Right);
+	input.bRightHeld = held(InputAction::Right);
+	// A soft drop tapped within one update still counts for it
+	input.bSoftDrop = (keys & ActionBit(InputAction::SoftDrop)) != 0;
+	input.bHardDrop = pressed(InputAction::HardDrop);
+	input.bRotateLeft = pressed(InputAction::RotateLeft);
+	input.bRotateRight = pressed(InputAction::RotateRight);
+	m_PressedActions = 0;
+
+	// While left or right is held, stop at each repeat so it moves when due
+	// rather than at the end of the update
+	bool bRepeating = input.bLeftHeld || input.bRightHeld;
+	do
+	{
+		float updateTime = deltaTime;
+		float repeatTime = m_Sim.GetInputRepeatTime();
+		if (bRepeating && repeatTime > 0.f && repeatTime < deltaTime)
+		{
+			updateTime = repeatTime;
+		}
+		m_Sim.Update(updateTime, input);
+		input.bLeft = input.bRight = input.bHardDrop = input.bRotateLeft = input.bRotateRight = false;
+		deltaTime -= updateTime;
+	} while (deltaTime > 0.f);
+}
+
+void SimThread::ApplyInput(InputEvent const& event)
+{
+	uint32_t bit = ActionBit(event.m_Action);
+	m_LastInputId = event.m_Id;
+	if (event.m_bDown)
+	{
+		m_HeldActions |= bit;
+		m_PressedActions |= bit;
+	}
+	else
+	{
+		m_HeldActions &= ~bit;
+	}
+}
+
+void SimThread::SkipInput(double now)
+{
+	while (InputEvent const* event = m_InputEvents.Front())
+	{
+		if (event->m_Time > now)
+		{
+			break;
+		}
+		ApplyInput(*event);
+		m_InputEvents.Pop();
+	}
+	m_PressedActions = 0;
+}
+
+void SimThread::Publish()
+{
+	if (m_Sim.GetChanges().HasAny())
+	{
+		++m_BoardVersion;
+	}
+	m_Sim.ClearChanges();
+
+	SimSnapshot& snapshot = m_Snapshots.GetWriteBuffer();
+	snapshot.Capture(m_Sim);
+	snapshot.m_PreviousFallingBlock = m_PreviousFallingBlock;
+	snapshot.m_BoardVersion = m_BoardVersion;
+	snapshot.m_GameIndex = m_GameIndex;
+	snapshot.m_StepTime = m_StepTime;
+	snapshot.m_InputId = m_LastInputId;
+	snapshot.m_StepDuration = m_StepDuration;
+	m_Snapshots.Publish();
+}
+
+}
@@ -0,0 +1,160 @@
+#pragma once
+#ifndef BLOCKDROP_SIM_THREAD_H
+#define BLOCKDROP_SIM_THREAD_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <thread>
+
+#include "Sim.h"
+#include "SimSnapshot.h"
+#include "SpscQueue.h"
+#include "TripleBuffer.h"
+
+namespace BlockDrop
+{
+
+// What a key does to the Sim. Presses of Left and Right move once, and
+// holding them repeats; SoftDrop lasts while held; the rest act per press.
+enum class InputAction : uint8_t
+{
+	Left,
+	Right,
+	SoftDrop,
+	HardDrop,
+	RotateLeft,
+	RotateRight,
+};
+
+struct InputEvent
+{
+	// On the clock SimThread::GetTime() uses
+	double m_Time{};
+	// Counts up from 1 in the order events are pushed
+	uint32_t m_Id{};
+	InputAction m_Action{};
+	bool m_bDown{};
+};
+
+// Steps a Sim at a fixed rate on its own thread, so slow frames don't hold up
+// gameplay and slow steps don't hold up drawing. Key events come in through
+// a queue and commands through atomics, and snapshots go out through a triple
+// buffer; neither side ever waits for the other.
+//
+// Key events carry the time they happened, and each step runs the Sim up to
+// each one in turn before applying it. A tap shorter than a frame still
+// lands, and held keys repeat on the Sim's timers rather than on frame
+// boundaries.
+//
+// Started without a thread, Advance() runs the same steps on the caller's
+// thread against a clock it moves on by hand. Headless tools do this so a
+// replay plays the same way every time.
+class SimThread
+{
+public:
+	static constexpr float s_StepSec = 1.0f / 60.0f;
+	// Longer hitches are dropped rather than caught up
+	static constexpr int s_MaxStepsPerTick = 5;
+	// Events not yet stepped, or stepped and not yet shown; more than this
+	// are dropped
+	static constexpr size_t s_MaxQueuedInputs = 256;
+
+public:
+	explicit SimThread(Sim& sim)
+		: m_Sim(sim)
+	{
+	}
+	~SimThread() { Stop(); }
+
+	SimThread(SimThread const&) = delete;
+	SimThread& operator=(SimThread const&) = delete;
+
+	// Publishes the Sim as it is now. With bThreaded, steps it in real time
+	// from then on; otherwise only Advance() steps it.
+	void Start(bool bThreaded);
+	// Joins the thread, after which the Sim can be used directly again
+	void Stop();
+
+	// Stamps a key going down or up with GetTime(). Call from one thread
+	// only, as soon as the platform reports it; without a thread, from the
+	// one that calls Advance(). Events from before Start() are dropped, and
+	// those that arrive while paused only update which keys are held.
+	void PushInput(InputAction action, bool bDown);
+	// Key presses that snapshot shows the effect of and that haven't been
+	// taken yet, oldest first, to measure how long they took to appear.
+	// Returns false when there are no more. One reader only.
+	bool TakeShownInput(SimSnapshot const& snapshot, InputEvent& event);
+	// Steps only while running; time spent paused isn't caught up
+	void SetRunning(bool bRunning) { m_bRunning.store(bRunning, std::memory_order_relaxed); }
+	// Starts a new game before the next step. Snapshots of it carry the
+	// returned game index.
+	uint32_t RequestReset() { return m_ResetRequests.fetch_add(1, std::memory_order_release) + 1; }
+
+	// Without a thread: moves the clock on and takes the steps that are due
+	void Advance(float elapsedTime);
+
+	// The latest snapshot; valid until the next call. One reader only.
+	SimSnapshot const& GetSnapshot()
+	{
+		m_Snapshots.Update();
+		return m_Snapshots.GetReadBuffer();
+	}
+	// Now, on the clock SimSnapshot::m_StepTime uses
+	double GetTime() const;
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+private:
+	void Run();
+	// Takes a pending reset and any steps due by now, then publishes if
+	// anything happened
+	void Tick(double now);
+	void Step();
+	// Runs the Sim for deltaTime with the keys as they are, using up presses
+	void Simulate(float deltaTime);
+	void ApplyInput(InputEvent const& event);
+	// Applies queued events up to now without stepping
+	void SkipInput(double now);
+	void Publish();
+
+private:
+	Sim& m_Sim;
+
+	std::thread m_Thread;
+	// Set before the thread starts, so both sides can read it
+	bool m_bThreaded{ false };
+	// Set once the clock is, for PushInput() on the platform's thread
+	std::atomic<bool> m_bStarted{ false };
+	std::atomic<bool> m_bStopping{ false };
+	Clock::time_point m_StartTime{};
+	// Clock for running without a thread
+	double m_ManualTime{};
+
+	SpscQueue<InputEvent, s_MaxQueuedInputs> m_InputEvents{};
+	// Owned by the thread that pushes input
+	uint32_t m_LastPushedInputId{};
+	// Presses as they're stepped, for TakeShownInput()
+	SpscQueue<InputEvent, s_MaxQueuedInputs> m_SteppedInputs{};
+	std::atomic<bool> m_bRunning{ false };
+	std::atomic<uint32_t> m_ResetRequests{};
+
+	// Owned by whichever thread steps
+	double m_StepTime{};
+	double m_StepDuration{};
+	uint32_t m_GameIndex{};
+	uint64_t m_BoardVersion{};
+	std::optional<TetronimoInstance> m_PreviousFallingBlock{};
+	// Bits by InputAction: keys down, and presses not yet simulated
+	uint32_t m_HeldActions{};
+	uint32_t m_PressedActions{};
+	uint32_t m_LastInputId{};
+
+	TripleBuffer<SimSnapshot> m_Snapshots{};
+};
+
+}
+
+#endif
@@ -0,0 +1,887 @@
+#include "SoftwareRenderer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define BLOCKDROP_SSE2
+	#include <emmintrin.h>
+#endif
+
+namespace BlockDrop
+{
+
+namespace
+{
+
+// Reserved when the frame is sized: more than a full board's tile quads plus
+// the UI, so commands recorded in a steady frame don't allocate
+constexpr size_t s_ReservedCommands = 2048;
+constexpr size_t s_ReservedTileCommands = 256;
+
+// x / 255, rounded, exact for x <= 255 * 255 * 2. The SSE2 paths use the same
+// formula so both produce identical frames.
+inline uint32_t Div255(uint32_t x)
+{
+	x += 128;
+	return (x + (x >> 8)) >> 8;
+}
+
+inline olc::Pixel Modulate(olc::Pixel a, olc::Pixel b)
+{
+	return olc::Pixel(
+		static_cast<uint8_t>(Div255(a.r * b.r)),
+		static_cast<uint8_t>(Div255(a.g * b.g)),
+		static_cast<uint8_t>(Div255(a.b * b.b)),
+		static_cast<uint8_t>(Div255(a.a * b.a)));
+}
+
+// Blend factors match Renderer_OGL10::SetDecalMode
+inline olc::Pixel BlendPixel(olc::DecalMode mode, olc::Pixel src, olc::Pixel dst)
+{
+	uint32_t a = src.a;
+	uint32_t ia = 255 - a;
+	auto channel = [&](uint32_t s, uint32_t d) {
+		uint32_t value;
+		switch (mode)
+		{
+		case olc::DecalMode::ADDITIVE:
+			value = d + Div255(s * a);
+			break;
+		case olc::DecalMode::MULTIPLICATIVE:
+			value = Div255(s * d + d * ia);
+			break;
+		case olc::DecalMode::STENCIL:
+			value = Div255(d * a);
+			break;
+		case olc::DecalMode::ILLUMINATE:
+			value = Div255(s * ia + d * a);
+			break;
+		default:
+			value = Div255(s * a + d * ia);
+			break;
+		}
+		return static_cast<uint8_t>(std::min(value, 255u));
+	};
+	return olc::Pixel(channel(src.r, dst.r), channel(src.g, dst.g), channel(src.b, dst.b), channel(src.a, dst.a));
+}
+
+void BlendSpanNormal(olc::Pixel* dst, olc::Pixel const* src, int count)
+{
+	int i = 0;
+#if defined(BLOCKDROP_SSE2)
+	__m128i const zero = _mm_setzero_si128();
+	__m128i const alphaMask = _mm_set1_epi32(static_cast<int>(0xFF000000));
+	__m128i const full = _mm_set1_epi16(255);
+	__m128i const round = _mm_set1_epi16(128);
+
+	// Two pixels per register as 16-bit lanes: s * a + d * (255 - a)
+	auto blend = [&](__m128i s16, __m128i d16) {
+		__m128i a16 = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s16, 0xFF), 0xFF);
+		__m128i x = _mm_add_epi16(
+			_mm_mullo_epi16(s16, a16),
+			_mm_mullo_epi16(d16, _mm_sub_epi16(full, a16)));
+		x = _mm_add_epi16(x, round);
+		return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+	};
+
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i s = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i));
+		__m128i alpha = _mm_and_si128(s, alphaMask);
+		if (_mm_movemask_epi8(_mm_cmpeq_epi32(alpha, alphaMask)) == 0xFFFF)
+		{
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), s);
+			continue;
+		}
+		if (_mm_movemask_epi8(_mm_cmpeq_epi32(alpha, zero)) == 0xFFFF)
+		{
+			continue;
+		}
+
+		__m128i d = _mm_loadu_si128(reinterpret_cast<__m128i const*>(dst + i));
+		__m128i lo = blend(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero));
+		__m128i hi = blend(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+	}
+#endif
+	for (; i < count; ++i)
+	{
+		dst[i] = BlendPixel(olc::DecalMode::NORMAL, src[i], dst[i]);
+	}
+}
+
+void ModulateSpan(olc::Pixel* span, int count, olc::Pixel tint)
+{
+	int i = 0;
+#if defined(BLOCKDROP_SSE2)
+	__m128i const zero = _mm_setzero_si128();
+	__m128i const round = _mm_set1_epi16(128);
+	__m128i const tint16 = _mm_unpacklo_epi8(_mm_set1_epi32(static_cast<int>(tint.n)), zero);
+
+	auto modulate = [&](__m128i s16) {
+		__m128i x = _mm_add_epi16(_mm_mullo_epi16(s16, tint16), round);
+		return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+	};
+
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i s = _mm_loadu_si128(reinterpret_cast<__m128i const*>(span + i));
+		__m128i lo = modulate(_mm_unpacklo_epi8(s, zero));
+		__m128i hi = modulate(_mm_unpackhi_epi8(s, zero));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(span + i), _mm_packus_epi16(lo, hi));
+	}
+#endif
+	for (; i < count; ++i)
+	{
+		span[i] = Modulate(span[i], tint);
+	}
+}
+
+void BlendSpan(olc::DecalMode mode, olc::Pixel* dst, olc::Pixel const* src, int count)
+{
+	if (mode == olc::DecalMode::NORMAL || mode == olc::DecalMode::WIREFRAME || mode == olc::DecalMode::MODEL3D)
+	{
+		BlendSpanNormal(dst, src, count);
+		return;
+	}
+
+	for (int i = 0; i < count; ++i)
+	{
+		dst[i] = BlendPixel(mode, src[i], dst[i]);
+	}
+}
+
+inline int TexelIndex(float coord, int size, bool bClamp)
+{
+	int index = static_cast<int>(std::floor(coord * static_cast<float>(size)));
+	if (bClamp)
+	{
+		return std::clamp(index, 0, size - 1);
+	}
+	index %= size;
+	return index < 0 ? index + size : index;
+}
+
+// Edge function; positive when p is left of a->b in y-down screen space
+inline float Edge(float ax, float ay, float bx, float by, float px, float py)
+{
+	return (bx - ax) * (py - ay) - (by - ay) * (px - ax);
+}
+
+// Top-left fill rule for triangles wound with positive area, so pixels on a
+// shared edge are drawn once
+inline bool IsTopLeft(float ax, float ay, float bx, float by)
+{
+	return (ay == by && bx > ax) || by < ay;
+}
+
+}
+
+SoftwareRenderer* SoftwareRenderer::s_Instance{};
+
+SoftwareRenderer::SoftwareRenderer()
+{
+	s_Instance = this;
+	SetThreadCount(static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+SoftwareRenderer::~SoftwareRenderer()
+{
+	if (s_Instance == this)
+	{
+		s_Instance = nullptr;
+	}
+}
+
+void SoftwareRenderer::SetThreadCount(int threadCount)
+{
+	threadCount = std::max(1, threadCount);
+	if (m_Pool != nullptr && m_Pool->GetThreadCount() == threadCount)
+	{
+		return;
+	}
+
+	Flush();
+	m_Pool = std::make_unique<WorkerPool>(threadCount);
+	m_Scratch.resize(threadCount);
+}
+
+olc::rcode SoftwareRenderer::CreateDevice(std::vector<void*>, bool, bool)
+{
+	return olc::rcode::OK;
+}
+
+olc::rcode SoftwareRenderer::DestroyDevice()
+{
+	m_Commands.clear();
+	m_Vertices.clear();
+	for (auto& commands : m_TileCommands)
+	{
+		commands.clear();
+	}
+	m_Textures.clear();
+	return olc::rcode::OK;
+}
+
+void SoftwareRenderer::DisplayFrame()
+{
+	Flush();
+	std::swap(m_Frame, m_Presented);
+	m_PresentedStats = m_Stats;
+	m_FrameCount++;
+}
+
+void SoftwareRenderer::PrepareDrawing()
+{
+	m_DecalMode = olc::DecalMode::NORMAL;
+	m_Stats = {};
+}
+
+void SoftwareRenderer::SetDecalMode(olc::DecalMode const& mode)
+{
+	m_DecalMode = mode;
+}
+
+void SoftwareRenderer::DrawLayerQuad(olc::vf2d const& offset, olc::vf2d const& scale, olc::Pixel const tint)
+{
+	if (GetTexture(m_BoundTexture) == nullptr)
+	{
+		return;
+	}
+
+	Command command{};
+	command.m_Type = CommandType::LayerQuad;
+	command.m_Mode = m_DecalMode;
+	command.m_Texture = m_BoundTexture;
+	command.m_Color = tint;
+	command.m_Offset = offset;
+	command.m_Scale = scale;
+	AddCommand(command, { 0, 0, m_FrameSize.x, m_FrameSize.y });
+}
+
+void SoftwareRenderer::DrawDecal(olc::DecalInstance const& decal)
+{
+	SetDecalMode(decal.mode);
+	m_BoundTexture = decal.decal == nullptr ? 0 : static_cast<uint32_t>(decal.decal->id);
+	m_Stats.m_DecalCount++;
+
+	if (m_Frame.empty() || decal.points < 2 || m_DecalMode == olc::DecalMode::MODEL3D)
+	{
+		return;
+	}
+
+	Command command{};
+	command.m_Mode = m_DecalMode;
+	command.m_Texture = GetTexture(m_BoundTexture) != nullptr ? m_BoundTexture : 0;
+	command.m_FirstVertex = static_cast<uint32_t>(m_Vertices.size());
+
+	if (m_DecalMode == olc::DecalMode::WIREFRAME)
+	{
+		// GL_LINE_LOOP
+		command.m_Type = CommandType::Lines;
+		for (uint32_t i = 0; i < decal.points; ++i)
+		{
+			AddLine(command, ToScreen(decal, i), ToScreen(decal, (i + 1) % decal.points));
+		}
+	}
+	else if (decal.structure == olc::DecalStructure::FAN && decal.points == 4 && IsAxisAlignedQuad(decal, 0, 1, 2, 3))
+	{
+		AddQuad(command, ToScreen(decal, 0), ToScreen(decal, 2));
+	}
+	else
+	{
+		command.m_Type = CommandType::Triangles;
+		switch (decal.structure)
+		{
+		case olc::DecalStructure::FAN:
+		{
+			Vertex first = ToScreen(decal, 0);
+			for (uint32_t i = 1; i + 1 < decal.points; ++i)
+			{
+				AddTriangle(command, first, ToScreen(decal, i), ToScreen(decal, i + 1));
+			}
+		} break;
+		case olc::DecalStructure::STRIP:
+		{
+			for (uint32_t i = 0; i + 2 < decal.points; ++i)
+			{
+				AddTriangle(command, ToScreen(decal, i), ToScreen(decal, i + 1), ToScreen(decal, i + 2));
+			}
+		} break;
+		case olc::DecalStructure::LIST:
+		{
+			// Batched meshes are mostly quads split into two triangles the
+			// way a fan would split them; those take the quad path
+			for (uint32_t i = 0; i + 2 < decal.points; i += 3)
+			{
+				if (i + 5 < decal.points && IsSplitQuad(decal, i))
+				{
+					if (command.m_VertexCount > 0)
+					{
+						AddCommand(command, command.m_Bounds);
+					}
+					Command quad = command;
+					AddQuad(quad, ToScreen(decal, i), ToScreen(decal, i + 2));
+					AddCommand(quad, quad.m_Bounds);
+
+					command.m_FirstVertex = static_cast<uint32_t>(m_Vertices.size());
+					command.m_VertexCount = 0;
+					i += 3;
+					continue;
+				}
+				AddTriangle(command, ToScreen(decal, i), ToScreen(decal, i + 1), ToScreen(decal, i + 2));
+			}
+		} break;
+		default:
+			// The OpenGL renderer draws nothing for LINE outside WIREFRAME mode
+			break;
+		}
+	}
+
+	if (command.m_VertexCount > 0)
+	{
+		AddCommand(command, command.m_Bounds);
+	}
+}
+
+uint32_t SoftwareRenderer::CreateTexture(uint32_t const width, uint32_t const height, bool const, bool const clamp)
+{
+	// Ids are slot + 1, so 0 can mean "no texture" as it does in OpenGL.
+	// Commands refer to textures by id, so growing m_Textures is safe.
+	auto slot = std::find_if(m_Textures.begin(), m_Textures.end(), [](Texture const& t) { return !t.m_bInUse; });
+	if (slot == m_Textures.end())
+	{
+		slot = m_Textures.emplace(m_Textures.end());
+	}
+
+	slot->m_Width = static_cast<int>(width);
+	slot->m_Height = static_cast<int>(height);
+	slot->m_bClamp = clamp;
+	slot->m_bInUse = true;
+	slot->m_bReferenced = false;
+	slot->m_Pixels.assign(static_cast<size_t>(width) * height, olc::BLANK);
+	return static_cast<uint32_t>(slot - m_Textures.begin()) + 1;
+}
+
+void SoftwareRenderer::UpdateTexture(uint32_t id, olc::Sprite* spr)
+{
+	if (id == 0 || id > m_Textures.size() || spr == nullptr)
+	{
+		return;
+	}
+
+	Texture& texture = m_Textures[id - 1];
+	if (texture.m_bReferenced)
+	{
+		// Recorded draws must see the old contents
+		Flush();
+	}
+	texture.m_Width = spr->width;
+	texture.m_Height = spr->height;
+	texture.m_Pixels.assign(spr->pColData.begin(), spr->pColData.end());
+}
+
+void SoftwareRenderer::ReadTexture(uint32_t id, olc::Sprite* spr)
+{
+	Texture const* texture = GetTexture(id);
+	if (texture == nullptr || spr == nullptr
+		|| spr->width != texture->m_Width || spr->height != texture->m_Height)
+	{
+		return;
+	}
+
+	std::copy(texture->m_Pixels.begin(), texture->m_Pixels.end(), spr->pColData.begin());
+}
+
+uint32_t SoftwareRenderer::DeleteTexture(uint32_t const id)
+{
+	if (id != 0 && id <= m_Textures.size())
+	{
+		Texture& texture = m_Textures[id - 1];
+		if (texture.m_bReferenced)
+		{
+			Flush();
+		}
+		texture.m_bInUse = false;
+		texture.m_Pixels = {};
+	}
+	return id;
+}
+
+void SoftwareRenderer::ApplyTexture(uint32_t id)
+{
+	m_BoundTexture = id;
+}
+
+void SoftwareRenderer::UpdateViewport(olc::vi2d const&, olc::vi2d const& size)
+{
+	if (size == m_FrameSize)
+	{
+		return;
+	}
+
+	Flush();
+	m_FrameSize = size;
+	size_t pixelCount = static_cast<size_t>(std::max(size.x, 0)) * std::max(size.y, 0);
+	m_Frame.assign(pixelCount, olc::BLACK);
+	m_Presented.assign(pixelCount, olc::BLACK);
+
+	m_TileCount = {
+		(std::max(size.x, 0) + s_TileSize - 1) / s_TileSize,
+		(std::max(size.y, 0) + s_TileSize - 1) / s_TileSize,
+	};
+	m_TileCommands.resize(static_cast<size_t>(m_TileCount.x) * m_TileCount.y);
+
+	m_Commands.reserve(s_ReservedCommands);
+	// Two per quad, or three per triangle
+	m_Vertices.reserve(3 * s_ReservedCommands);
+	for (auto& commands : m_TileCommands)
+	{
+		commands.reserve(s_ReservedTileCommands);
+	}
+}
+
+void SoftwareRenderer::ClearBuffer(olc::Pixel p, bool)
+{
+	Command command{};
+	command.m_Type = CommandType::Clear;
+	command.m_Color = p;
+	AddCommand(command, { 0, 0, m_FrameSize.x, m_FrameSize.y });
+}
+
+SoftwareRenderer::Texture const* SoftwareRenderer::GetTexture(uint32_t id) const
+{
+	if (id == 0 || id > m_Textures.size() || !m_Textures[id - 1].m_bInUse
+		|| m_Textures[id - 1].m_Pixels.empty())
+	{
+		return nullptr;
+	}
+	return &m_Textures[id - 1];
+}
+
+olc::Pixel SoftwareRenderer::Sample(Texture const* texture, float u, float v) const
+{
+	int x = TexelIndex(u, texture->m_Width, texture->m_bClamp);
+	int y = TexelIndex(v, texture->m_Height, texture->m_bClamp);
+	return texture->m_Pixels[y * texture->m_Width + x];
+}
+
+SoftwareRenderer::Vertex SoftwareRenderer::ToScreen(olc::DecalInstance const& decal, uint32_t index) const
+{
+	// Decal positions are normalised device coordinates, y up
+	return Vertex{
+		(decal.pos[index].x + 1.0f) * 0.5f * static_cast<float>(m_FrameSize.x),
+		(1.0f - decal.pos[index].y) * 0.5f * static_cast<float>(m_FrameSize.y),
+		decal.uv[index].x,
+		decal.uv[index].y,
+		decal.w[index],
+		decal.tint[index],
+	};
+}
+
+bool SoftwareRenderer::IsAxisAlignedQuad(olc::DecalInstance const& decal, uint32_t tl, uint32_t bl, uint32_t br, uint32_t tr) const
+{
+	auto const& p = decal.pos;
+	auto const& uv = decal.uv;
+	auto const& w = decal.w;
+	auto const& tint = decal.tint;
+	return p[tl].x == p[bl].x && p[br].x == p[tr].x && p[tl].y == p[tr].y && p[bl].y == p[br].y
+		&& uv[tl].x == uv[bl].x && uv[br].x == uv[tr].x && uv[tl].y == uv[tr].y && uv[bl].y == uv[br].y
+		&& w[tl] == 1.0f && w[bl] == 1.0f && w[br] == 1.0f && w[tr] == 1.0f
+		&& tint[tl] == tint[bl] && tint[tl] == tint[br] && tint[tl] == tint[tr];
+}
+
+bool SoftwareRenderer::IsSplitQuad(olc::DecalInstance const& decal, uint32_t first) const
+{
+	// Triangles (TL, BL, BR) and (TL, BR, TR), as a fan would split the quad
+	auto same = [&](uint32_t a, uint32_t b) {
+		return decal.pos[a] == decal.pos[b] && decal.uv[a] == decal.uv[b]
+			&& decal.w[a] == decal.w[b] && decal.tint[a] == decal.tint[b];
+	};
+	return same(first, first + 3) && same(first + 2, first + 4)
+		&& IsAxisAlignedQuad(decal, first, first + 1, first + 2, first + 5);
+}
+
+void SoftwareRenderer::AddQuad(Command& command, Vertex const& topLeft, Vertex const& bottomRight)
+{
+	command.m_Type = CommandType::Quad;
+	command.m_FirstVertex = static_cast<uint32_t>(m_Vertices.size());
+	m_Vertices.push_back(topLeft);
+	m_Vertices.push_back(bottomRight);
+	command.m_VertexCount = 2;
+	m_Stats.m_QuadCount++;
+
+	// Pixels whose centres fall inside the quad
+	command.m_Bounds = {
+		static_cast<int>(std::ceil(std::min(topLeft.m_X, bottomRight.m_X) - 0.5f)),
+		static_cast<int>(std::ceil(std::min(topLeft.m_Y, bottomRight.m_Y) - 0.5f)),
+		static_cast<int>(std::ceil(std::max(topLeft.m_X, bottomRight.m_X) - 0.5f)),
+		static_cast<int>(std::ceil(std::max(topLeft.m_Y, bottomRight.m_Y) - 0.5f)),
+	};
+}
+
+void SoftwareRenderer::AddCommand(Command command, Rect bounds)
+{
+	bounds.m_Left = std::max(bounds.m_Left, 0);
+	bounds.m_Top = std::max(bounds.m_Top, 0);
+	bounds.m_Right = std::min(bounds.m_Right, m_FrameSize.x);
+	bounds.m_Bottom = std::min(bounds.m_Bottom, m_FrameSize.y);
+	if (bounds.m_Left >= bounds.m_Right || bounds.m_Top >= bounds.m_Bottom)
+	{
+		return;
+	}
+
+	command.m_Bounds = bounds;
+	if (command.m_Texture != 0)
+	{
+		m_Textures[command.m_Texture - 1].m_bReferenced = true;
+	}
+
+	uint32_t index = static_cast<uint32_t>(m_Commands.size());
+	m_Commands.push_back(command);
+
+	// Bin by bounding box; the rasterizers clip to the tile
+	for (int ty = bounds.m_Top / s_TileSize; ty <= (bounds.m_Bottom - 1) / s_TileSize; ++ty)
+	{
+		for (int tx = bounds.m_Left / s_TileSize; tx <= (bounds.m_Right - 1) / s_TileSize; ++tx)
+		{
+			m_TileCommands[ty * m_TileCount.x + tx].push_back(index);
+		}
+	}
+}
+
+void SoftwareRenderer::AddTriangle(Command& command, Vertex const& a, Vertex const& b, Vertex const& c)
+{
+	Rect bounds{
+		static_cast<int>(std::floor(std::min({ a.m_X, b.m_X, c.m_X }))),
+		static_cast<int>(std::floor(std::min({ a.m_Y, b.m_Y, c.m_Y }))),
+		static_cast<int>(std::ceil(std::max({ a.m_X, b.m_X, c.m_X }))),
+		static_cast<int>(std::ceil(std::max({ a.m_Y, b.m_Y, c.m_Y }))),
+	};
+
+	Rect& total = command.m_Bounds;
+	if (command.m_VertexCount == 0)
+	{
+		total = bounds;
+	}
+	else
+	{
+		total = {
+			std::min(total.m_Left, bounds.m_Left), std::min(total.m_Top, bounds.m_Top),
+			std::max(total.m_Right, bounds.m_Right), std::max(total.m_Bottom, bounds.m_Bottom),
+		};
+	}
+
+	m_Vertices.push_back(a);
+	m_Vertices.push_back(b);
+	m_Vertices.push_back(c);
+	command.m_VertexCount += 3;
+	m_Stats.m_TriangleCount++;
+}
+
+void SoftwareRenderer::AddLine(Command& command, Vertex const& a, Vertex const& b)
+{
+	Rect bounds{
+		static_cast<int>(std::floor(std::min(a.m_X, b.m_X))),
+		static_cast<int>(std::floor(std::min(a.m_Y, b.m_Y))),
+		static_cast<int>(std::floor(std::max(a.m_X, b.m_X))) + 1,
+		static_cast<int>(std::floor(std::max(a.m_Y, b.m_Y))) + 1,
+	};
+
+	Rect& total = command.m_Bounds;
+	if (command.m_VertexCount == 0)
+	{
+		total = bounds;
+	}
+	else
+	{
+		total = {
+			std::min(total.m_Left, bounds.m_Left), std::min(total.m_Top, bounds.m_Top),
+			std::max(total.m_Right, bounds.m_Right), std::max(total.m_Bottom, bounds.m_Bottom),
+		};
+	}
+
+	m_Vertices.push_back(a);
+	m_Vertices.push_back(b);
+	command.m_VertexCount += 2;
+}
+
+void SoftwareRenderer::Flush()
+{
+	if (m_Commands.empty())
+	{
+		return;
+	}
+
+	m_Pool->ParallelFor(static_cast<int>(m_TileCommands.size()), [this](int tile, int threadIndex) {
+		RasterizeTile(tile, m_Scratch[threadIndex]);
+	});
+
+	for (auto& commands : m_TileCommands)
+	{
+		commands.clear();
+	}
+	for (auto const& command : m_Commands)
+	{
+		if (command.m_Texture != 0)
+		{
+			m_Textures[command.m_Texture - 1].m_bReferenced = false;
+		}
+	}
+	m_Commands.clear();
+	m_Vertices.clear();
+
+	for (auto& scratch : m_Scratch)
+	{
+		m_Stats.m_PixelsShaded += scratch.m_PixelsShaded;
+		scratch.m_PixelsShaded = 0;
+	}
+}
+
+void SoftwareRenderer::RasterizeTile(int tile, Scratch& scratch)
+{
+	int left = (tile % m_TileCount.x) * s_TileSize;
+	int top = (tile / m_TileCount.x) * s_TileSize;
+	Rect tileRect{ left, top, std::min(left + s_TileSize, m_FrameSize.x), std::min(top + s_TileSize, m_FrameSize.y) };
+
+	for (uint32_t index : m_TileCommands[tile])
+	{
+		Command const& command = m_Commands[index];
+		Rect clip{
+			std::max(tileRect.m_Left, command.m_Bounds.m_Left),
+			std::max(tileRect.m_Top, command.m_Bounds.m_Top),
+			std::min(tileRect.m_Right, command.m_Bounds.m_Right),
+			std::min(tileRect.m_Bottom, command.m_Bounds.m_Bottom),
+		};
+
+		Vertex const* vertices = &m_Vertices[command.m_FirstVertex];
+		switch (command.m_Type)
+		{
+		case CommandType::Clear:
+			RasterizeClear(command, clip);
+			break;
+		case CommandType::LayerQuad:
+			RasterizeLayerQuad(command, clip, scratch);
+			break;
+		case CommandType::Quad:
+			RasterizeQuad(command, clip, scratch);
+			break;
+		case CommandType::Triangles:
+			for (uint32_t i = 0; i < command.m_VertexCount; i += 3)
+			{
+				RasterizeTriangle(command, vertices[i], vertices[i + 1], vertices[i + 2], clip, scratch);
+			}
+			break;
+		case CommandType::Lines:
+			for (uint32_t i = 0; i < command.m_VertexCount; i += 2)
+			{
+				RasterizeLine(command, vertices[i], vertices[i + 1], clip, scratch);
+			}
+			break;
+		}
+	}
+}
+
+void SoftwareRenderer::RasterizeClear(Command const& command, Rect const& clip)
+{
+	for (int y = clip.m_Top; y < clip.m_Bottom; ++y)
+	{
+		olc::Pixel* row = &m_Frame[y * m_FrameSize.x];
+		std::fill(row + clip.m_Left, row + clip.m_Right, command.m_Color);
+	}
+}
+
+void SoftwareRenderer::RasterizeLayerQuad(Command const& command, Rect const& clip, Scratch& scratch)
+{
+	Texture const* texture = GetTexture(command.m_Texture);
+	int width = m_FrameSize.x;
+	int height = m_FrameSize.y;
+	int count = clip.m_Right - clip.m_Left;
+	if (scratch.m_Span.size() < static_cast<size_t>(count))
+	{
+		scratch.m_Span.resize(count);
+	}
+
+	bool bUnscaled = command.m_Offset == olc::vf2d{ 0.0f, 0.0f } && command.m_Scale == olc::vf2d{ 1.0f, 1.0f }
+		&& texture->m_Width == width && texture->m_Height == height;
+
+	for (int y = clip.m_Top; y < clip.m_Bottom; ++y)
+	{
+		olc::Pixel const* src;
+		if (bUnscaled && command.m_Color == olc::WHITE)
+		{
+			src = &texture->m_Pixels[y * width + clip.m_Left];
+		}
+		else
+		{
+			float v = (static_cast<float>(y) + 0.5f) / static_cast<float>(height) * command.m_Scale.y + command.m_Offset.y;
+			for (int i = 0; i < count; ++i)
+			{
+				float u = (static_cast<float>(clip.m_Left + i) + 0.5f) / static_cast<float>(width) * command.m_Scale.x + command.m_Offset.x;
+				scratch.m_Span[i] = Sample(texture, u, v);
+			}
+			if (command.m_Color != olc::WHITE)
+			{
+				ModulateSpan(scratch.m_Span.data(), count, command.m_Color);
+			}
+			src = scratch.m_Span.data();
+		}
+		BlendSpan(command.m_Mode, &m_Frame[y * width + clip.m_Left], src, count);
+	}
+	scratch.m_PixelsShaded += static_cast<uint64_t>(count) * (clip.m_Bottom - clip.m_Top);
+}
+
+void SoftwareRenderer::RasterizeQuad(Command const& command, Rect const& clip, Scratch& scratch)
+{
+	Texture const* texture = GetTexture(command.m_Texture);
+	Vertex const& topLeft = m_Vertices[command.m_FirstVertex];
+	Vertex const& bottomRight = m_Vertices[command.m_FirstVertex + 1];
+
+	int count = clip.m_Right - clip.m_Left;
+	if (scratch.m_Span.size() < static_cast<size_t>(count))
+	{
+		scratch.m_Span.resize(count);
+	}
+	if (scratch.m_SpanTexels.size() < static_cast<size_t>(count))
+	{
+		scratch.m_SpanTexels.resize(count);
+	}
+
+	olc::Pixel tint = topLeft.m_Tint;
+	float du = 0.0f;
+	float dv = 0.0f;
+	if (texture != nullptr)
+	{
+		du = (bottomRight.m_U - topLeft.m_U) / (bottomRight.m_X - topLeft.m_X);
+		dv = (bottomRight.m_V - topLeft.m_V) / (bottomRight.m_Y - topLeft.m_Y);
+		for (int i = 0; i < count; ++i)
+		{
+			float u = topLeft.m_U + (static_cast<float>(clip.m_Left + i) + 0.5f - topLeft.m_X) * du;
+			scratch.m_SpanTexels[i] = TexelIndex(u, texture->m_Width, texture->m_bClamp);
+		}
+	}
+	else
+	{
+		std::fill_n(scratch.m_Span.begin(), count, tint);
+	}
+
+	for (int y = clip.m_Top; y < clip.m_Bottom; ++y)
+	{
+		if (texture != nullptr)
+		{
+			float v = topLeft.m_V + (static_cast<float>(y) + 0.5f - topLeft.m_Y) * dv;
+			olc::Pixel const* texels = &texture->m_Pixels[TexelIndex(v, texture->m_Height, texture->m_bClamp) * texture->m_Width];
+			for (int i = 0; i < count; ++i)
+			{
+				scratch.m_Span[i] = texels[scratch.m_SpanTexels[i]];
+			}
+			if (tint != olc::WHITE)
+			{
+				ModulateSpan(scratch.m_Span.data(), count, tint);
+			}
+		}
+		BlendSpan(command.m_Mode, &m_Frame[y * m_FrameSize.x + clip.m_Left], scratch.m_Span.data(), count);
+	}
+
+	scratch.m_PixelsShaded += static_cast<uint64_t>(count) * (clip.m_Bottom - clip.m_Top);
+}
+
+void SoftwareRenderer::RasterizeTriangle(Command const& command, Vertex const& a, Vertex const& b0, Vertex const& c0, Rect const& clip, Scratch& scratch)
+{
+	float area = Edge(a.m_X, a.m_Y, b0.m_X, b0.m_Y, c0.m_X, c0.m_Y);
+	if (area == 0.0f)
+	{
+		return;
+	}
+	// Rewind so area is positive; the fill rule depends on it
+	Vertex const& b = area > 0.0f ? b0 : c0;
+	Vertex const& c = area > 0.0f ? c0 : b0;
+	area = std::abs(area);
+
+	Texture const* texture = GetTexture(command.m_Texture);
+	int left = std::max(clip.m_Left, static_cast<int>(std::floor(std::min({ a.m_X, b.m_X, c.m_X }))));
+	int right = std::min(clip.m_Right, static_cast<int>(std::ceil(std::max({ a.m_X, b.m_X, c.m_X }))));
+	int top = std::max(clip.m_Top, static_cast<int>(std::floor(std::min({ a.m_Y, b.m_Y, c.m_Y }))));
+	int bottom = std::min(clip.m_Bottom, static_cast<int>(std::ceil(std::max({ a.m_Y, b.m_Y, c.m_Y }))));
+
+	bool bTopLeftA = IsTopLeft(b.m_X, b.m_Y, c.m_X, c.m_Y);
+	bool bTopLeftB = IsTopLeft(c.m_X, c.m_Y, a.m_X, a.m_Y);
+	bool bTopLeftC = IsTopLeft(a.m_X, a.m_Y, b.m_X, b.m_Y);
+
+	for (int y = top; y < bottom; ++y)
+	{
+		float py = static_cast<float>(y) + 0.5f;
+		for (int x = left; x < right; ++x)
+		{
+			float px = static_cast<float>(x) + 0.5f;
+			float ea = Edge(b.m_X, b.m_Y, c.m_X, c.m_Y, px, py);
+			float eb = Edge(c.m_X, c.m_Y, a.m_X, a.m_Y, px, py);
+			float ec = Edge(a.m_X, a.m_Y, b.m_X, b.m_Y, px, py);
+			if (ea < 0.0f || eb < 0.0f || ec < 0.0f
+				|| (ea == 0.0f && !bTopLeftA) || (eb == 0.0f && !bTopLeftB) || (ec == 0.0f && !bTopLeftC))
+			{
+				continue;
+			}
+
+			float la = ea / area;
+			float lb = eb / area;
+			float lc = ec / area;
+			auto lerp = [&](float va, float vb, float vc) { return va * la + vb * lb + vc * lc; };
+
+			olc::Pixel color(
+				static_cast<uint8_t>(lerp(a.m_Tint.r, b.m_Tint.r, c.m_Tint.r) + 0.5f),
+				static_cast<uint8_t>(lerp(a.m_Tint.g, b.m_Tint.g, c.m_Tint.g) + 0.5f),
+				static_cast<uint8_t>(lerp(a.m_Tint.b, b.m_Tint.b, c.m_Tint.b) + 0.5f),
+				static_cast<uint8_t>(lerp(a.m_Tint.a, b.m_Tint.a, c.m_Tint.a) + 0.5f));
+			if (texture != nullptr)
+			{
+				// uv is pre-multiplied by w (glTexCoord4f), so divide back out
+				float q = lerp(a.m_W, b.m_W, c.m_W);
+				color = Modulate(Sample(texture, lerp(a.m_U, b.m_U, c.m_U) / q, lerp(a.m_V, b.m_V, c.m_V) / q), color);
+			}
+
+			olc::Pixel& dst = m_Frame[y * m_FrameSize.x + x];
+			dst = BlendPixel(command.m_Mode, color, dst);
+			scratch.m_PixelsShaded++;
+		}
+	}
+}
+
+void SoftwareRenderer::RasterizeLine(Command const& command, Vertex const& a, Vertex const& b, Rect const& clip, Scratch& scratch)
+{
+	// One sample per pixel along the major axis, end point excluded so line
+	// loops don't draw corners twice
+	Texture const* texture = GetTexture(command.m_Texture);
+	float dx = b.m_X - a.m_X;
+	float dy = b.m_Y - a.m_Y;
+	int steps = static_cast<int>(std::max(std::abs(dx), std::abs(dy)));
+	for (int i = 0; i < steps; ++i)
+	{
+		float t = (static_cast<float>(i) + 0.5f) / static_cast<float>(steps);
+		int x = static_cast<int>(std::floor(a.m_X + dx * t));
+		int y = static_cast<int>(std::floor(a.m_Y + dy * t));
+		if (x < clip.m_Left || y < clip.m_Top || x >= clip.m_Right || y >= clip.m_Bottom)
+		{
+			continue;
+		}
+
+		auto lerp = [&](float va, float vb) { return va + (vb - va) * t; };
+		olc::Pixel color(
+			static_cast<uint8_t>(lerp(a.m_Tint.r, b.m_Tint.r) + 0.5f),
+			static_cast<uint8_t>(lerp(a.m_Tint.g, b.m_Tint.g) + 0.5f),
+			static_cast<uint8_t>(lerp(a.m_Tint.b, b.m_Tint.b) + 0.5f),
+			static_cast<uint8_t>(lerp(a.m_Tint.a, b.m_Tint.a) + 0.5f));
+		if (texture != nullptr)
+		{
+			float q = lerp(a.m_W, b.m_W);
+			color = Modulate(Sample(texture, lerp(a.m_U, b.m_U) / q, lerp(a.m_V, b.m_V) / q), color);
+		}
+
+		olc::Pixel& dst = m_Frame[y * m_FrameSize.x + x];
+		dst = BlendPixel(command.m_Mode, color, dst);
+		scratch.m_PixelsShaded++;
+	}
+}
+
+}
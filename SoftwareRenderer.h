@@ -0,0 +1,194 @@
+#pragma once
+#ifndef BLOCKDROP_SOFTWARE_RENDERER_H
+#define BLOCKDROP_SOFTWARE_RENDERER_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "olcPixelGameEngine.h"
+
+#include "WorkerPool.h"
+
+namespace BlockDrop
+{
+
+// CPU implementation of olc::Renderer, used in place of the no-op renderer in
+// headless builds so layers and decals end up in a readable framebuffer.
+//
+// Follows the OpenGL 1.0 renderer: layers are drawn back to front, each as a
+// full-screen quad followed by its decals, blended per DecalMode. Textures are
+// copied on upload and sampled nearest-neighbour. Axis-aligned quads with a
+// single tint (DrawDecal, DrawPartialDecal, FillRectDecal, strings) take a
+// span fast path; anything else goes through a general triangle rasterizer.
+// MODEL3D decals are skipped, as the OpenGL renderer does without
+// OLC_ENABLE_EXPERIMENTAL.
+//
+// Draws are recorded rather than executed, then binned into s_TileSize
+// screen tiles when the frame is presented. Tiles are rasterized in parallel;
+// each tile replays its commands in submission order and every pixel is
+// computed the same way whichever tile it falls in, so the frame is
+// identical for any thread count.
+class SoftwareRenderer : public olc::Renderer
+{
+public:
+	static constexpr int s_TileSize = 64;
+
+	struct Stats
+	{
+		uint32_t m_DecalCount{};
+		uint32_t m_QuadCount{};
+		uint32_t m_TriangleCount{};
+		uint64_t m_PixelsShaded{};
+	};
+
+public:
+	SoftwareRenderer();
+	~SoftwareRenderer() override;
+
+	// The renderer olc::PixelGameEngine created, or null before the engine is
+	// constructed. The engine keeps its renderer private.
+	static SoftwareRenderer* Get() { return s_Instance; }
+
+	// Defaults to one per hardware thread
+	void SetThreadCount(int threadCount);
+	int GetThreadCount() const { return m_Pool->GetThreadCount(); }
+
+	olc::vi2d GetFrameSize() const { return m_FrameSize; }
+	// Last presented frame, row-major, m_FrameSize.x pixels per row
+	olc::Pixel const* GetFrame() const { return m_Presented.data(); }
+	uint64_t GetFrameCount() const { return m_FrameCount; }
+	// Counters for the last presented frame
+	Stats const& GetStats() const { return m_PresentedStats; }
+
+	void PrepareDevice() override {}
+	olc::rcode CreateDevice(std::vector<void*> params, bool bFullScreen, bool bVSYNC) override;
+	olc::rcode DestroyDevice() override;
+	void DisplayFrame() override;
+	void PrepareDrawing() override;
+	void SetDecalMode(olc::DecalMode const& mode) override;
+	void DrawLayerQuad(olc::vf2d const& offset, olc::vf2d const& scale, olc::Pixel const tint) override;
+	void DrawDecal(olc::DecalInstance const& decal) override;
+	uint32_t CreateTexture(uint32_t const width, uint32_t const height, bool const filtered = false, bool const clamp = true) override;
+	void UpdateTexture(uint32_t id, olc::Sprite* spr) override;
+	void ReadTexture(uint32_t id, olc::Sprite* spr) override;
+	uint32_t DeleteTexture(uint32_t const id) override;
+	void ApplyTexture(uint32_t id) override;
+	void UpdateViewport(olc::vi2d const& pos, olc::vi2d const& size) override;
+	void ClearBuffer(olc::Pixel p, bool bDepth) override;
+
+private:
+	struct Texture
+	{
+		int m_Width{};
+		int m_Height{};
+		bool m_bClamp{ true };
+		bool m_bInUse{ false };
+		// Used by a recorded command; updates must flush first
+		bool m_bReferenced{ false };
+		std::vector<olc::Pixel> m_Pixels;
+	};
+
+	struct Vertex
+	{
+		float m_X;
+		float m_Y;
+		float m_U;
+		float m_V;
+		float m_W;
+		olc::Pixel m_Tint;
+	};
+
+	// Pixel rectangle, right and bottom exclusive
+	struct Rect
+	{
+		int m_Left;
+		int m_Top;
+		int m_Right;
+		int m_Bottom;
+	};
+
+	enum class CommandType : uint8_t
+	{
+		Clear,
+		LayerQuad,
+		Quad,
+		Triangles,
+		Lines,
+	};
+
+	struct Command
+	{
+		CommandType m_Type;
+		olc::DecalMode m_Mode;
+		uint32_t m_Texture;
+		// Clear colour or layer tint
+		olc::Pixel m_Color;
+		// Layer quads: texture offset and scale; others: range in m_Vertices
+		// (two corners for a quad, three per triangle, two per line)
+		olc::vf2d m_Offset;
+		olc::vf2d m_Scale;
+		uint32_t m_FirstVertex;
+		uint32_t m_VertexCount;
+		Rect m_Bounds;
+	};
+
+	// Per-thread scratch rows for the quad path
+	struct Scratch
+	{
+		std::vector<olc::Pixel> m_Span;
+		std::vector<int> m_SpanTexels;
+		uint64_t m_PixelsShaded{};
+	};
+
+private:
+	Texture const* GetTexture(uint32_t id) const;
+	olc::Pixel Sample(Texture const* texture, float u, float v) const;
+	Vertex ToScreen(olc::DecalInstance const& decal, uint32_t index) const;
+
+	// Corners given by index, in the order DrawDecal and friends produce
+	bool IsAxisAlignedQuad(olc::DecalInstance const& decal, uint32_t tl, uint32_t bl, uint32_t br, uint32_t tr) const;
+	// Six list vertices from first on that make up one such quad
+	bool IsSplitQuad(olc::DecalInstance const& decal, uint32_t first) const;
+	void AddCommand(Command command, Rect bounds);
+	void AddQuad(Command& command, Vertex const& topLeft, Vertex const& bottomRight);
+	void AddTriangle(Command& command, Vertex const& a, Vertex const& b, Vertex const& c);
+	void AddLine(Command& command, Vertex const& a, Vertex const& b);
+
+	// Rasterizes everything recorded so far
+	void Flush();
+	void RasterizeTile(int tile, Scratch& scratch);
+	void RasterizeClear(Command const& command, Rect const& clip);
+	void RasterizeLayerQuad(Command const& command, Rect const& clip, Scratch& scratch);
+	void RasterizeQuad(Command const& command, Rect const& clip, Scratch& scratch);
+	void RasterizeTriangle(Command const& command, Vertex const& a, Vertex const& b, Vertex const& c, Rect const& clip, Scratch& scratch);
+	void RasterizeLine(Command const& command, Vertex const& a, Vertex const& b, Rect const& clip, Scratch& scratch);
+
+private:
+	static SoftwareRenderer* s_Instance;
+
+	olc::vi2d m_FrameSize{};
+	std::vector<olc::Pixel> m_Frame;
+	std::vector<olc::Pixel> m_Presented;
+	uint64_t m_FrameCount{};
+
+	std::vector<Texture> m_Textures;
+	uint32_t m_BoundTexture{};
+	olc::DecalMode m_DecalMode{ olc::DecalMode::NORMAL };
+
+	// Recorded since the last flush; reused between frames
+	std::vector<Command> m_Commands;
+	std::vector<Vertex> m_Vertices;
+	olc::vi2d m_TileCount{};
+	std::vector<std::vector<uint32_t>> m_TileCommands;
+
+	std::unique_ptr<WorkerPool> m_Pool;
+	std::vector<Scratch> m_Scratch;
+
+	Stats m_Stats{};
+	Stats m_PresentedStats{};
+};
+
+}
+
+#endif
@@ -0,0 +1,61 @@
+#pragma once
+#ifndef BLOCKDROP_SPSC_QUEUE_H
+#define BLOCKDROP_SPSC_QUEUE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace BlockDrop
+{
+
+// A fixed size queue from one writer thread to one reader thread, without
+// locks. Each side owns its own index and only reads the other's, so neither
+// ever waits; a full queue refuses new values instead.
+template <typename T, size_t Capacity>
+class SpscQueue
+{
+	static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+	// Writer: returns false, dropping value, if the queue is full
+	bool Push(T const& value)
+	{
+		size_t tail = m_Tail.load(std::memory_order_relaxed);
+		if (tail - m_Head.load(std::memory_order_acquire) == Capacity)
+		{
+			return false;
+		}
+		m_Values[tail & s_IndexMask] = value;
+		m_Tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Reader: the oldest value, or nullptr if there are none. Valid until Pop().
+	T const* Front() const
+	{
+		size_t head = m_Head.load(std::memory_order_relaxed);
+		if (head == m_Tail.load(std::memory_order_acquire))
+		{
+			return nullptr;
+		}
+		return &m_Values[head & s_IndexMask];
+	}
+	// Reader: removes the value Front() returned
+	void Pop()
+	{
+		m_Head.store(m_Head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+private:
+	static constexpr size_t s_IndexMask = Capacity - 1;
+
+	std::array<T, Capacity> m_Values{};
+	// Kept on separate cache lines so the two sides don't contend
+	alignas(64) std::atomic<size_t> m_Head{};
+	alignas(64) std::atomic<size_t> m_Tail{};
+};
+
+}
+
+#endif
@@ -0,0 +1,207 @@
+#include "TileAtlas.h"
+
+#include <cassert>
+
+namespace BlockDrop
+{
+
+void TileAtlas::Build(olc::PixelGameEngine& pge, olc::Sprite& tile, int tileSizePx)
+{
+	m_TileSizePx = tileSizePx;
+	m_Sprite = std::make_unique<olc::Sprite>(s_Columns * tileSizePx, s_Rows * tileSizePx);
+
+	pge.SetDrawTarget(m_Sprite.get());
+	pge.Clear(olc::BLANK);
+	for (int colorIndex = 0; colorIndex < s_Rows; ++colorIndex)
+	{
+		TileColor tileColor = static_cast<TileColor>(colorIndex + 1);
+		olc::Pixel color = GetColor(tileColor);
+
+		// Tinted the way a decal tint modulates, rounding each channel of
+		// tile * color / 255, so it matches the white tile drawn tinted
+		auto modulate = [](uint8_t a, uint8_t b) { return static_cast<uint8_t>((a * b + 127) / 255); };
+		olc::vi2d tileTopLeft = GetTile(tileColor);
+		for (int y = 0; y < tileSizePx; ++y)
+		{
+			for (int x = 0; x < tileSizePx; ++x)
+			{
+				olc::Pixel p = tile.GetPixel(x * tile.width / tileSizePx, y * tile.height / tileSizePx);
+				m_Sprite->SetPixel(tileTopLeft + olc::vi2d{ x, y },
+					olc::Pixel(modulate(p.r, color.r), modulate(p.g, color.g), modulate(p.b, color.b), modulate(p.a, color.a)));
+			}
+		}
+
+		for (int mask = 0; mask < 16; ++mask)
+		{
+			BorderDirection directions = static_cast<BorderDirection>(mask);
+			olc::vi2d topLeft = GetOutline(tileColor, directions);
+			olc::vi2d bottomRight = topLeft + olc::vi2d{ tileSizePx - 1, tileSizePx - 1 };
+
+			if (HasDirection(directions, BorderDirection::Top))
+			{
+				pge.DrawLine(topLeft.x, topLeft.y, bottomRight.x, topLeft.y, color); // top
+			}
+			if (HasDirection(directions, BorderDirection::Right))
+			{
+				pge.DrawLine(bottomRight.x, topLeft.y, bottomRight.x, bottomRight.y, color); // right
+			}
+			if (HasDirection(directions, BorderDirection::Bottom))
+			{
+				pge.DrawLine(topLeft.x, bottomRight.y, bottomRight.x, bottomRight.y, color); // bottom
+			}
+			if (HasDirection(directions, BorderDirection::Left))
+			{
+				pge.DrawLine(topLeft.x, topLeft.y, topLeft.x, bottomRight.y, color); // left
+			}
+		}
+	}
+	pge.SetDrawTarget(nullptr);
+
+	m_Decal = std::make_unique<olc::Decal>(m_Sprite.get());
+}
+
+olc::Pixel TileAtlas::GetColor(TileColor color)
+{
+	switch (color)
+	{
+	case TileColor::Red:
+		return olc::RED;
+	case TileColor::Blue:
+		return olc::BLUE;
+	case TileColor::Cyan:
+		return olc::CYAN;
+	case TileColor::Magenta:
+		return olc::MAGENTA;
+	case TileColor::Yellow:
+		return olc::YELLOW;
+	case TileColor::Green:
+		return olc::GREEN;
+	case TileColor::Orange:
+		return olc::Pixel(0xec, 0x97, 0x06);
+	default:
+		assert(0);
+		return olc::BLACK;
+	}
+}
+
+void BoardMesh::Clear()
+{
+	m_Positions.clear();
+	m_UVs.clear();
+	m_Tints.clear();
+}
+
+void BoardMesh::Reserve(int tileCount)
+{
+	size_t vertexCount = static_cast<size_t>(tileCount) * 6;
+	m_Positions.reserve(vertexCount);
+	m_UVs.reserve(vertexCount);
+	m_Tints.reserve(vertexCount);
+}
+
+void BoardMesh::AddBoard(SimSnapshot const& sim, olc::vi2d topLeft, TileAtlas const& atlas, olc::vi2d fallOffset)
+{
+	int tileSize = atlas.GetTileSize();
+	auto boardToScreen = [&](int row, int col) { return topLeft + olc::vi2d{ col, row } * tileSize; };
+
+	// The drop preview goes first so the falling block covers it
+	auto const& optFallingBlock = sim.GetFallingBlock();
+	if (optFallingBlock.has_value())
+	{
+		auto const& tetronimo = optFallingBlock.value();
+		auto position = sim.GetDropPosition();
+		for (auto& square : tetronimo.GetSquares())
+		{
+			int row = position.y + square.m_Row;
+			int col = position.x + square.m_Column;
+
+			if (row < 0 || row > sim.GetHeight() || col < 0 || col > sim.GetWidth())
+			{
+				continue;
+			}
+			AddTile(boardToScreen(row, col), atlas, atlas.GetOutline(tetronimo.GetTileColor(), square.m_Directions));
+		}
+	}
+
+	for (int row = 0; row < sim.GetHeight(); ++row)
+	{
+		for (int col = 0; col < sim.GetWidth(); ++col)
+		{
+			const auto tile = sim.At(row, col);
+			if (tile == TileColor::None)
+			{
+				continue;
+			}
+
+			AddTile(boardToScreen(row, col), atlas, atlas.GetTile(tile));
+		}
+	}
+
+	if (optFallingBlock.has_value())
+	{
+		auto const& tetronimo = optFallingBlock.value();
+		olc::vi2d atlasPos = atlas.GetTile(tetronimo.GetTileColor());
+		olc::vi2d origin = boardToScreen(tetronimo.GetPosition().y, tetronimo.GetPosition().x) + fallOffset;
+		for (auto& square : tetronimo.GetSquares())
+		{
+			olc::vi2d pos = origin + olc::vi2d{ square.m_Column * tileSize, square.m_Row * tileSize };
+			if (pos.y < topLeft.y)
+			{
+				continue;
+			}
+			AddTile(pos, atlas, atlasPos);
+		}
+	}
+}
+
+void BoardMesh::AddTile(olc::vi2d pos, TileAtlas const& atlas, olc::vi2d atlasPos)
+{
+	olc::vi2d size{ atlas.GetTileSize(), atlas.GetTileSize() };
+
+	// Same corners and winding as DrawDecal's fan, split into two triangles
+	olc::vf2d topLeft = pos;
+	olc::vf2d bottomRight = pos + size;
+	olc::vf2d const corners[] = {
+		topLeft, { topLeft.x, bottomRight.y }, bottomRight,
+		topLeft, bottomRight, { bottomRight.x, topLeft.y },
+	};
+	olc::vf2d uvScale = atlas.GetDecal()->vUVScale;
+	olc::vf2d uvTopLeft = olc::vf2d(atlasPos) * uvScale;
+	olc::vf2d uvBottomRight = olc::vf2d(atlasPos + size) * uvScale;
+	olc::vf2d const uvs[] = {
+		uvTopLeft, { uvTopLeft.x, uvBottomRight.y }, uvBottomRight,
+		uvTopLeft, uvBottomRight, { uvBottomRight.x, uvTopLeft.y },
+	};
+	for (int i = 0; i < 6; ++i)
+	{
+		m_Positions.push_back(corners[i]);
+		m_UVs.push_back(uvs[i]);
+		// Colour is already in the atlas
+		m_Tints.push_back(olc::WHITE);
+	}
+}
+
+void BoardMesh::Append(BoardMesh const& other)
+{
+	m_Positions.insert(m_Positions.end(), other.m_Positions.begin(), other.m_Positions.end());
+	m_UVs.insert(m_UVs.end(), other.m_UVs.begin(), other.m_UVs.end());
+	m_Tints.insert(m_Tints.end(), other.m_Tints.begin(), other.m_Tints.end());
+}
+
+void BoardMesh::Draw(olc::PixelGameEngine& pge, TileAtlas const& atlas) const
+{
+	if (IsEmpty())
+	{
+		return;
+	}
+
+	pge.SetDecalStructure(olc::DecalStructure::LIST);
+	pge.DrawExplicitDecal(atlas.GetDecal(),
+		m_Positions.data(),
+		m_UVs.data(),
+		m_Tints.data(),
+		static_cast<uint32_t>(m_Positions.size()));
+	pge.SetDecalStructure(olc::DecalStructure::FAN);
+}
+
+}
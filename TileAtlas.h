@@ -0,0 +1,80 @@
+#pragma once
+#ifndef BLOCKDROP_TILE_ATLAS_H
+#define BLOCKDROP_TILE_ATLAS_H
+
+#include <memory>
+#include <vector>
+
+#include "olcPixelGameEngine.h"
+
+#include "Sim.h"
+#include "SimSnapshot.h"
+
+namespace BlockDrop
+{
+
+// Every tile image a board needs, coloured ahead of time at one tile size: a
+// row per colour holding the tinted tile, then its drop preview outline for
+// each BorderDirection combination. Draws from it need no tint, and any number
+// of boards drawn at that size can share it.
+class TileAtlas
+{
+public:
+	static constexpr int s_Columns{ 1 + 16 };
+	static constexpr int s_Rows{ 7 };
+
+public:
+	// Scales tile to tileSizePx and colours it, drawing with pge. Leaves the
+	// draw target unset.
+	void Build(olc::PixelGameEngine& pge, olc::Sprite& tile, int tileSizePx);
+
+	olc::Decal* GetDecal() const { return m_Decal.get(); }
+	int GetTileSize() const { return m_TileSizePx; }
+
+	olc::vi2d GetTile(TileColor color) const
+	{
+		return { 0, (static_cast<int>(color) - 1) * m_TileSizePx };
+	}
+	olc::vi2d GetOutline(TileColor color, BorderDirection directions) const
+	{
+		return GetTile(color) + olc::vi2d{ (1 + static_cast<int>(directions)) * m_TileSizePx, 0 };
+	}
+
+	static olc::Pixel GetColor(TileColor color);
+
+private:
+	int m_TileSizePx{};
+	std::unique_ptr<olc::Sprite> m_Sprite{};
+	std::unique_ptr<olc::Decal> m_Decal{};
+};
+
+// Tiles from a TileAtlas as one triangle list, so a board, or many boards, are
+// a single decal however full they are
+struct BoardMesh
+{
+	// Six vertices per tile; capacity is kept between rebuilds
+	std::vector<olc::vf2d> m_Positions;
+	std::vector<olc::vf2d> m_UVs;
+	std::vector<olc::Pixel> m_Tints;
+	bool m_bDirty{ true };
+
+	bool IsEmpty() const { return m_Positions.empty(); }
+	void Clear();
+	// Room for tileCount tiles, so filling up later doesn't allocate
+	void Reserve(int tileCount);
+
+	// The drop preview, settled tiles and falling block of a board, with its
+	// top left corner at topLeft. The falling block is moved by fallOffset
+	// pixels, to draw it between rows.
+	void AddBoard(SimSnapshot const& sim, olc::vi2d topLeft, TileAtlas const& atlas, olc::vi2d fallOffset = {});
+	// Atlas cell atlasPos drawn at pos
+	void AddTile(olc::vi2d pos, TileAtlas const& atlas, olc::vi2d atlasPos);
+	void Append(BoardMesh const& other);
+
+	// One DrawExplicitDecal on the current layer
+	void Draw(olc::PixelGameEngine& pge, TileAtlas const& atlas) const;
+};
+
+}
+
+#endif
@@ -0,0 +1,54 @@
+#pragma once
+#ifndef BLOCKDROP_TRIPLE_BUFFER_H
+#define BLOCKDROP_TRIPLE_BUFFER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace BlockDrop
+{
+
+// Hands values from one writer thread to one reader thread without locks.
+// The writer fills its buffer and publishes it by swapping it with the shared
+// one; the reader swaps the shared one for its own when a newer one is there.
+// Neither side ever waits. The reader always has the latest complete value,
+// and values it was too slow to see are skipped.
+template <typename T>
+class TripleBuffer
+{
+public:
+	// Writer: fill this, then Publish()
+	T& GetWriteBuffer() { return m_Buffers[m_WriteIndex]; }
+	void Publish()
+	{
+		uint8_t previous = m_Shared.exchange(static_cast<uint8_t>(m_WriteIndex | s_FreshBit), std::memory_order_acq_rel);
+		m_WriteIndex = previous & s_IndexMask;
+	}
+
+	// Reader: returns true if a newer value was taken
+	bool Update()
+	{
+		if ((m_Shared.load(std::memory_order_relaxed) & s_FreshBit) == 0)
+		{
+			return false;
+		}
+		uint8_t previous = m_Shared.exchange(m_ReadIndex, std::memory_order_acq_rel);
+		m_ReadIndex = previous & s_IndexMask;
+		return true;
+	}
+	T const& GetReadBuffer() const { return m_Buffers[m_ReadIndex]; }
+
+private:
+	static constexpr uint8_t s_IndexMask = 0x3;
+	static constexpr uint8_t s_FreshBit = 0x4;
+
+	std::array<T, 3> m_Buffers{};
+	uint8_t m_WriteIndex{ 0 };
+	std::atomic<uint8_t> m_Shared{ 1 };
+	uint8_t m_ReadIndex{ 2 };
+};
+
+}
+
+#endif
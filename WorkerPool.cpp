@@ -0,0 +1,87 @@
+#include "WorkerPool.h"
+
+#include <algorithm>
+
+namespace BlockDrop
+{
+
+WorkerPool::WorkerPool(int threadCount)
+{
+	for (int i = 1; i < std::max(1, threadCount); ++i)
+	{
+		m_Threads.emplace_back(&WorkerPool::ThreadLoop, this, i);
+	}
+}
+
+WorkerPool::~WorkerPool()
+{
+	m_bStopping = true;
+	m_Generation.fetch_add(1, std::memory_order_release);
+	m_Generation.notify_all();
+	for (auto& thread : m_Threads)
+	{
+		thread.join();
+	}
+}
+
+void WorkerPool::Run(int count, void* context, Task task)
+{
+	if (m_Threads.empty() || count <= 1)
+	{
+		for (int i = 0; i < count; ++i)
+		{
+			task(context, i, 0);
+		}
+		return;
+	}
+
+	m_Context = context;
+	m_Task = task;
+	m_Count = count;
+	m_Next.store(0, std::memory_order_relaxed);
+	m_Pending.store(static_cast<int>(m_Threads.size()), std::memory_order_relaxed);
+	m_Generation.fetch_add(1, std::memory_order_release);
+	m_Generation.notify_all();
+
+	Work(0);
+
+	// Every worker checks out of every job, so none can still be looking at
+	// this one when the next is set up
+	int pending = m_Pending.load(std::memory_order_acquire);
+	while (pending != 0)
+	{
+		m_Pending.wait(pending, std::memory_order_acquire);
+		pending = m_Pending.load(std::memory_order_acquire);
+	}
+}
+
+void WorkerPool::Work(int threadIndex)
+{
+	int index;
+	while ((index = m_Next.fetch_add(1, std::memory_order_relaxed)) < m_Count)
+	{
+		m_Task(m_Context, index, threadIndex);
+	}
+}
+
+void WorkerPool::ThreadLoop(int threadIndex)
+{
+	uint32_t seen = 0;
+	while (true)
+	{
+		m_Generation.wait(seen, std::memory_order_acquire);
+		seen = m_Generation.load(std::memory_order_acquire);
+		if (m_bStopping)
+		{
+			return;
+		}
+
+		Work(threadIndex);
+		if (m_Pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			m_Pending.notify_one();
+		}
+	}
+}
+
+}
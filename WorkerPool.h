@@ -0,0 +1,64 @@
+#pragma once
+#ifndef BLOCKDROP_WORKER_POOL_H
+#define BLOCKDROP_WORKER_POOL_H
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace BlockDrop
+{
+
+// A fixed set of threads that run one ParallelFor at a time. The calling
+// thread takes part as thread 0, so a pool of one runs everything inline.
+// Indices are handed out dynamically, so which thread runs which index
+// varies between calls; results must not depend on it.
+class WorkerPool
+{
+public:
+	explicit WorkerPool(int threadCount);
+	WorkerPool(WorkerPool&) = delete;
+	~WorkerPool();
+
+	int GetThreadCount() const { return static_cast<int>(m_Threads.size()) + 1; }
+
+	// Calls fn(index, threadIndex) for every index in [0, count) and returns
+	// once all calls have finished. threadIndex is in [0, GetThreadCount()).
+	template <typename Fn>
+	void ParallelFor(int count, Fn&& fn)
+	{
+		using Function = std::remove_reference_t<Fn>;
+		Run(count, &fn, [](void* context, int index, int threadIndex) {
+			(*static_cast<Function*>(context))(index, threadIndex);
+		});
+	}
+
+private:
+	using Task = void (*)(void* context, int index, int threadIndex);
+
+private:
+	void Run(int count, void* context, Task task);
+	void Work(int threadIndex);
+	void ThreadLoop(int threadIndex);
+
+private:
+	std::vector<std::thread> m_Threads;
+
+	// The current job; only written while every worker is idle
+	void* m_Context{};
+	Task m_Task{};
+	int m_Count{};
+	std::atomic<int> m_Next{};
+
+	// Bumped to start a job; workers atomic-wait on it
+	std::atomic<uint32_t> m_Generation{};
+	// Workers yet to finish the current job
+	std::atomic<int> m_Pending{};
+	bool m_bStopping{ false };
+};
+
+}
+
+#endif
@@ -1,7 +1,22 @@
+#include <cstdio>
+
 #include "Game.h"
+#include "Mosaic.h"
 
-int WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, char*, int nShowCmd)
+int WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, char* cmdLine, int nShowCmd)
 {
+	// "--mosaic N" watches N boards play instead of starting a game
+	int boardCount = 0;
+	if (cmdLine != nullptr && std::sscanf(cmdLine, "--mosaic %d", &boardCount) == 1)
+	{
+		BlockDrop::Mosaic mosaic(boardCount, static_cast<uint32_t>(time(nullptr)));
+		if (mosaic.Construct(BlockDrop::Mosaic::s_ScreenWidthPx, BlockDrop::Mosaic::s_ScreenHeightPx, 1, 1, false, true))
+		{
+			mosaic.Start();
+		}
+		return 0;
+	}
+
 	BlockDrop::App app;
 	if (app.Construct(BlockDrop::App::ScreenWidthPx, BlockDrop::App::s_ScreenHeightPx, 1, 1, false, true))
 	{
@@ -1,2 +1,17 @@
+#if defined(OLC_PGE_HEADLESS)
+// Headless builds still load tile.png, and draw into a framebuffer that tools
+// can read back instead of discarding decals
+#if !defined(OLC_IMAGE_STB) && !defined(_WIN32)
+#define OLC_IMAGE_LIBPNG
+#endif
+#include "olcPixelGameEngine.h"
+#include "SoftwareRenderer.h"
+#define OLC_GFX_CUSTOM_EX
+#define OLC_RENDERER_CUSTOM_EX BlockDrop::SoftwareRenderer
+#endif
+
+// Defines OLC_PROFILE_ZONE for the frame loop
+#include "Profiler.h"
+
 #define OLC_PGE_APPLICATION
 #include "olcPixelGameEngine.h"
\ No newline at end of file
@@ -396,6 +396,7 @@ int main()
 #include <algorithm>
 #include <array>
 #include <cstring>
+#include <cstdio> // BlockDrop: snprintf for the title bar
 #pragma endregion
 
 #define PGE_VER 224
@@ -906,6 +907,10 @@ namespace olc
 		olc::Renderable pDrawTarget;
 		uint32_t nResID = 0;
 		std::vector<DecalInstance> vecDecalInstance;
+		// BlockDrop: decals queued this frame are the first nDecalInstances;
+		// the rest keep their buffers for later frames, so queueing a decal
+		// doesn't allocate once the pool has grown
+		uint32_t nDecalInstances = 0;
 		olc::Pixel tint = olc::WHITE;
 		std::function<void()> funcHook = nullptr;
 	};
@@ -980,6 +985,12 @@ namespace olc
 		virtual void OnTextEntryComplete(const std::string& sText);
 		// Called when a console command is executed
 		virtual bool OnConsoleCommand(const std::string& sCommand);
+		// BlockDrop: called as a key goes down or up, on the thread the
+		// platform reports it on, before the next frame sees it. OS key
+		// repeats aren't reported.
+		virtual void OnKeyStateChanged(Key key, bool bDown);
+		// BlockDrop: called once the frame has been handed to the display
+		virtual void OnFramePresented();
 
 
 	public: // Hardware Interfaces
@@ -1108,6 +1119,9 @@ namespace olc
 		// Decal Quad functions
 		void SetDecalMode(const olc::DecalMode& mode);
 		void SetDecalStructure(const olc::DecalStructure& structure);
+		// BlockDrop: adds nDecals instances to the target layer's pool, each
+		// with room for nPoints, so frames drawing that many don't allocate
+		void ReserveDecals(uint32_t nDecals, uint32_t nPoints = 4);
 		// Draws a whole decal, with optional scale and tinting
 		void DrawDecal(const olc::vf2d& pos, olc::Decal* decal, const olc::vf2d& scale = { 1.0f,1.0f }, const olc::Pixel& tint = olc::WHITE);
 		// Draws a region of a decal, with optional scale and tinting
@@ -1230,6 +1244,8 @@ namespace olc
 		float		fFrameTimer = 1.0f;
 		float		fLastElapsed = 0.0f;
 		int			nFrameCount = 0;		
+		// BlockDrop: kept between updates so the title doesn't allocate
+		std::string sTitle;
 		bool bSuspendTextureTransfer = false;
 		Renderable  fontRenderable;
 		std::vector<LayerDesc> vLayers;
@@ -1296,6 +1312,9 @@ namespace olc
 		void olc_PrepareEngine();
 		void olc_UpdateMouseState(int32_t button, bool state);
 		void olc_UpdateKeyState(int32_t key, bool state);
+		// BlockDrop: the next instance from the target layer's pool, reset,
+		// preferring one already big enough for nPoints
+		olc::DecalInstance& olc_NewDecalInstance(uint32_t nPoints = 4);
 		void olc_UpdateMouseFocus(bool state);
 		void olc_UpdateKeyFocus(bool state);
 		void olc_Terminate();
@@ -1451,6 +1470,18 @@ namespace olc
 // | olcPixelGameEngine INTERFACE IMPLEMENTATION (CORE)                           |
 // | Note: The core implementation is platform independent                        |
 // O------------------------------------------------------------------------------O
+// BlockDrop: scoped timing zones in the frame loop, if defined before the
+// implementation is included
+#ifndef OLC_PROFILE_ZONE
+	#define OLC_PROFILE_ZONE(name) ((void)0)
+#endif
+
+// BlockDrop: SSE2 stores for the NORMAL pixel mode span fills below
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define OLC_PGE_SSE2_SPANS
+	#include <emmintrin.h>
+#endif
+
 #pragma region pge_implementation
 namespace olc
 {
@@ -2141,6 +2172,25 @@ namespace olc
 	bool PixelGameEngine::Draw(const olc::vi2d& pos, Pixel p)
 	{ return Draw(pos.x, pos.y, p); }
 
+	// BlockDrop: fills count pixels from dst, sixteen per loop on SSE2
+	static void olc_FillSpan(Pixel* dst, int32_t count, Pixel p)
+	{
+		int32_t i = 0;
+#if defined(OLC_PGE_SSE2_SPANS)
+		__m128i v = _mm_set1_epi32(int32_t(p.n));
+		for (; i + 16 <= count; i += 16)
+		{
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), v);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 4), v);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 8), v);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 12), v);
+		}
+		for (; i + 4 <= count; i += 4)
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), v);
+#endif
+		for (; i < count; i++) dst[i] = p;
+	}
+
 	// This is it, the critical function that plots a pixel
 	bool PixelGameEngine::Draw(int32_t x, int32_t y, Pixel p)
 	{
@@ -2193,10 +2243,22 @@ namespace olc
 		x1 = p1.x; y1 = p1.y;
 		x2 = p2.x; y2 = p2.y;
 
+		// BlockDrop: solid straight lines in NORMAL mode write straight to the
+		// target, clipped to it rather than to the screen
+		const bool bSolid = nPixelMode == Pixel::NORMAL && pattern == 0xFFFFFFFF && pDrawTarget != nullptr;
+
 		// straight lines idea by gurkanctn
 		if (dx == 0) // Line is vertical
 		{
 			if (y2 < y1) std::swap(y1, y2);
+			if (bSolid)
+			{
+				const int32_t w = pDrawTarget->width, h = pDrawTarget->height;
+				if (x1 < 0 || x1 >= w) return;
+				Pixel* m = pDrawTarget->GetData() + x1;
+				for (y = std::max(y1, 0); y <= std::min(y2, h - 1); y++) m[y * w] = p;
+				return;
+			}
 			for (y = y1; y <= y2; y++) if (rol()) Draw(x1, y, p);
 			return;
 		}
@@ -2204,6 +2266,14 @@ namespace olc
 		if (dy == 0) // Line is horizontal
 		{
 			if (x2 < x1) std::swap(x1, x2);
+			if (bSolid)
+			{
+				const int32_t w = pDrawTarget->width, h = pDrawTarget->height;
+				if (y1 < 0 || y1 >= h) return;
+				x1 = std::max(x1, 0); x2 = std::min(x2, w - 1);
+				olc_FillSpan(pDrawTarget->GetData() + y1 * w + x1, x2 - x1 + 1, p);
+				return;
+			}
 			for (x = x1; x <= x2; x++) if (rol()) Draw(x, y1, p);
 			return;
 		}
@@ -2361,7 +2431,7 @@ namespace olc
 	{
 		int pixels = GetDrawTargetWidth() * GetDrawTargetHeight();
 		Pixel* m = GetDrawTarget()->GetData();
-		for (int i = 0; i < pixels; i++) m[i] = p;
+		olc_FillSpan(m, pixels, p); // BlockDrop
 	}
 
 	void PixelGameEngine::ClearBuffer(Pixel p, bool bDepth)
@@ -2427,6 +2497,15 @@ namespace olc
 		if (y2 < 0) y2 = 0;
 		if (y2 >= (int32_t)GetDrawTargetHeight()) y2 = (int32_t)GetDrawTargetHeight();
 
+		// BlockDrop: row spans in NORMAL mode instead of a Draw per pixel
+		if (nPixelMode == Pixel::NORMAL && pDrawTarget != nullptr)
+		{
+			Pixel* m = pDrawTarget->GetData();
+			for (int j = y; j < y2; j++)
+				olc_FillSpan(m + j * pDrawTarget->width + x, x2 - x, p);
+			return;
+		}
+
 		for (int i = x; i < x2; i++)
 			for (int j = y; j < y2; j++)
 				Draw(i, j, p);
@@ -2823,6 +2902,19 @@ namespace olc
 	void PixelGameEngine::SetDecalStructure(const olc::DecalStructure& structure)
 	{ nDecalStructure = structure; }
 
+	void PixelGameEngine::ReserveDecals(uint32_t nDecals, uint32_t nPoints)
+	{
+		auto& pool = vLayers[nTargetLayer].vecDecalInstance;
+		for (uint32_t i = 0; i < nDecals; i++)
+		{
+			DecalInstance& di = pool.emplace_back();
+			di.pos.reserve(nPoints);
+			di.uv.reserve(nPoints);
+			di.w.reserve(nPoints);
+			di.tint.reserve(nPoints);
+		}
+	}
+
 	void PixelGameEngine::DrawPartialDecal(const olc::vf2d& pos, olc::Decal* decal, const olc::vf2d& source_pos, const olc::vf2d& source_size, const olc::vf2d& scale, const olc::Pixel& tint)
 	{
 		olc::vf2d vScreenSpacePos =
@@ -2842,7 +2934,7 @@ namespace olc
 		olc::vf2d vQuantisedPos = ((vScreenSpacePos * vWindow) + olc::vf2d(0.5f, 0.5f)).floor() / vWindow;
 		olc::vf2d vQuantisedDim = ((vScreenSpaceDim * vWindow) + olc::vf2d(0.5f, -0.5f)).ceil() / vWindow;
 
-		DecalInstance di;
+		DecalInstance& di = olc_NewDecalInstance();
 		di.points = 4;
 		di.decal = decal;
 		di.tint = { tint, tint, tint, tint };
@@ -2853,7 +2945,6 @@ namespace olc
 		di.w = { 1,1,1,1 };
 		di.mode = nDecalMode;
 		di.structure = nDecalStructure;
-		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
 	}
 
 	void PixelGameEngine::DrawPartialDecal(const olc::vf2d& pos, const olc::vf2d& size, olc::Decal* decal, const olc::vf2d& source_pos, const olc::vf2d& source_size, const olc::Pixel& tint)
@@ -2870,7 +2961,7 @@ namespace olc
 			vScreenSpacePos.y - (2.0f * size.y * vInvScreenSize.y)
 		};
 
-		DecalInstance di;
+		DecalInstance& di = olc_NewDecalInstance();
 		di.points = 4;
 		di.decal = decal;
 		di.tint = { tint, tint, tint, tint };
@@ -2881,7 +2972,6 @@ namespace olc
 		di.w = { 1,1,1,1 };
 		di.mode = nDecalMode;
 		di.structure = nDecalStructure;
-		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
 	}
 
 
@@ -2899,7 +2989,7 @@ namespace olc
 			vScreenSpacePos.y - (2.0f * (float(decal->sprite->height) * vInvScreenSize.y)) * scale.y
 		};
 
-		DecalInstance di;
+		DecalInstance& di = olc_NewDecalInstance();
 		di.decal = decal;
 		di.points = 4;
 		di.tint = { tint, tint, tint, tint };
@@ -2908,12 +2998,11 @@ namespace olc
 		di.w = { 1, 1, 1, 1 };
 		di.mode = nDecalMode;
 		di.structure = nDecalStructure;
-		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
 	}
 
 	void PixelGameEngine::DrawExplicitDecal(olc::Decal* decal, const olc::vf2d* pos, const olc::vf2d* uv, const olc::Pixel* col, uint32_t elements)
 	{
-		DecalInstance di;
+		DecalInstance& di = olc_NewDecalInstance(elements);
 		di.decal = decal;
 		di.pos.resize(elements);
 		di.uv.resize(elements);
@@ -2929,12 +3018,11 @@ namespace olc
 		}
 		di.mode = nDecalMode;
 		di.structure = nDecalStructure;
-		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
 	}
 
 	void PixelGameEngine::DrawPolygonDecal(olc::Decal* decal, const std::vector<olc::vf2d>& pos, const std::vector<olc::vf2d>& uv, const olc::Pixel tint)
 	{
-		DecalInstance di;
+		DecalInstance& di = olc_NewDecalInstance(uint32_t(pos.size()));
 		di.decal = decal;
 		di.points = uint32_t(pos.size());
 		di.pos.resize(di.points);
@@ -2950,12 +3038,11 @@ namespace olc
 		}
 		di.mode = nDecalMode;
 		di.structure = nDecalStructure;
-		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
 	}
 
 	void PixelGameEngine::DrawPolygonDecal(olc::Decal* decal, const std::vector<olc::vf2d>& pos, const std::vector<olc::vf2d>& uv, const std::vector<olc::Pixel> &tint)
 	{
-		DecalInstance di;
+		DecalInstance& di = olc_NewDecalInstance(uint32_t(pos.size()));
 		di.decal = decal;
 		di.points = uint32_t(pos.size());
 		di.pos.resize(di.points);
@@ -2971,7 +3058,6 @@ namespace olc
 		}
 		di.mode = nDecalMode;
 		di.structure = nDecalStructure;
-		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
 	}
 
 	void PixelGameEngine::DrawPolygonDecal(olc::Decal* decal, const std::vector<olc::vf2d>& pos, const std::vector<olc::vf2d>& uv, const std::vector<olc::Pixel>& colours, const olc::Pixel tint)
@@ -2985,7 +3071,7 @@ namespace olc
 
 	void PixelGameEngine::DrawPolygonDecal(olc::Decal* decal, const std::vector<olc::vf2d>& pos, const std::vector<float>& depth, const std::vector<olc::vf2d>& uv, const olc::Pixel tint)
 	{
-		DecalInstance di;
+		DecalInstance& di = olc_NewDecalInstance(uint32_t(pos.size()));
 		di.decal = decal;
 		di.points = uint32_t(pos.size());
 		di.pos.resize(di.points);
@@ -3001,14 +3087,13 @@ namespace olc
 		}
 		di.mode = nDecalMode;
 		di.structure = nDecalStructure;
-		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
 	}
 
 #ifdef OLC_ENABLE_EXPERIMENTAL
 	// Lightweight 3D
 	void PixelGameEngine::LW3D_DrawTriangles(olc::Decal* decal, const std::vector<std::array<float, 3>>& pos, const std::vector<olc::vf2d>& tex, const std::vector<olc::Pixel>& col)
 	{
-		DecalInstance di;
+		DecalInstance& di = olc_NewDecalInstance(uint32_t(pos.size()));
 		di.decal = decal;
 		di.points = uint32_t(pos.size());
 		di.pos.resize(di.points);
@@ -3023,7 +3108,6 @@ namespace olc
 			di.tint[i] = col[i];			
 		}
 		di.mode = DecalMode::MODEL3D;
-		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
 	}
 #endif
 
@@ -3086,7 +3170,7 @@ namespace olc
 
 	void PixelGameEngine::DrawRotatedDecal(const olc::vf2d& pos, olc::Decal* decal, const float fAngle, const olc::vf2d& center, const olc::vf2d& scale, const olc::Pixel& tint)
 	{
-		DecalInstance di;
+		DecalInstance& di = olc_NewDecalInstance();
 		di.decal = decal;
 		di.pos.resize(4);
 		di.uv = { { 0.0f, 0.0f}, {0.0f, 1.0f}, {1.0f, 1.0f}, {1.0f, 0.0f} };
@@ -3107,13 +3191,12 @@ namespace olc
 		}
 		di.mode = nDecalMode;
 		di.structure = nDecalStructure;
-		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
 	}
 
 
 	void PixelGameEngine::DrawPartialRotatedDecal(const olc::vf2d& pos, olc::Decal* decal, const float fAngle, const olc::vf2d& center, const olc::vf2d& source_pos, const olc::vf2d& source_size, const olc::vf2d& scale, const olc::Pixel& tint)
 	{
-		DecalInstance di;
+		DecalInstance& di = olc_NewDecalInstance();
 		di.decal = decal;
 		di.points = 4;
 		di.tint = { tint, tint, tint, tint };
@@ -3136,12 +3219,11 @@ namespace olc
 		di.uv = { { uvtl.x, uvtl.y }, { uvtl.x, uvbr.y }, { uvbr.x, uvbr.y }, { uvbr.x, uvtl.y } };
 		di.mode = nDecalMode;
 		di.structure = nDecalStructure;
-		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
 	}
 
 	void PixelGameEngine::DrawPartialWarpedDecal(olc::Decal* decal, const olc::vf2d* pos, const olc::vf2d& source_pos, const olc::vf2d& source_size, const olc::Pixel& tint)
 	{
-		DecalInstance di;
+		DecalInstance& di = olc_NewDecalInstance();
 		di.points = 4;
 		di.decal = decal;
 		di.tint = { tint, tint, tint, tint };
@@ -3169,7 +3251,11 @@ namespace olc
 			}
 			di.mode = nDecalMode;
 			di.structure = nDecalStructure;
-			vLayers[nTargetLayer].vecDecalInstance.push_back(di);
+		}
+		else
+		{
+			// BlockDrop: nothing to draw, so give the instance back
+			vLayers[nTargetLayer].nDecalInstances--;
 		}
 	}
 
@@ -3177,7 +3263,7 @@ namespace olc
 	{
 		// Thanks Nathan Reed, a brilliant article explaining whats going on here
 		// http://www.reedbeta.com/blog/quadrilateral-interpolation-part-1/
-		DecalInstance di;
+		DecalInstance& di = olc_NewDecalInstance();
 		di.points = 4;
 		di.decal = decal;
 		di.tint = { tint, tint, tint, tint };
@@ -3201,7 +3287,11 @@ namespace olc
 			}
 			di.mode = nDecalMode;
 			di.structure = nDecalStructure;
-			vLayers[nTargetLayer].vecDecalInstance.push_back(di);
+		}
+		else
+		{
+			// BlockDrop: nothing to draw, so give the instance back
+			vLayers[nTargetLayer].nDecalInstances--;
 		}
 	}
 
@@ -3681,6 +3771,8 @@ namespace olc
 
 	void PixelGameEngine::OnTextEntryComplete(const std::string& sText) { UNUSED(sText); }
 	bool PixelGameEngine::OnConsoleCommand(const std::string& sCommand) { UNUSED(sCommand); return false; }
+	void PixelGameEngine::OnKeyStateChanged(Key key, bool bDown) { UNUSED(key); UNUSED(bDown); }
+	void PixelGameEngine::OnFramePresented() {}
 	
 	// Externalised API
 	void PixelGameEngine::olc_UpdateViewport()
@@ -3739,7 +3831,42 @@ namespace olc
 	{ pMouseNewState[button] = state; }
 
 	void PixelGameEngine::olc_UpdateKeyState(int32_t key, bool state)
-	{ pKeyNewState[key] = state; }
+	{
+		// BlockDrop: report changes as they arrive rather than a frame later
+		if (pKeyNewState[key] != state) OnKeyStateChanged(Key(key), state);
+		pKeyNewState[key] = state;
+	}
+
+	olc::DecalInstance& PixelGameEngine::olc_NewDecalInstance(uint32_t nPoints)
+	{
+		// BlockDrop: reuse a pooled instance, keeping its buffers' capacity.
+		// Of the free ones, take the smallest that fits nPoints, else the
+		// biggest, so a big decal finds the instance that grew for it
+		// whatever order the frame's decals come in.
+		LayerDesc& layer = vLayers[nTargetLayer];
+		if (layer.nDecalInstances == layer.vecDecalInstance.size())
+			layer.vecDecalInstance.emplace_back();
+		auto first = layer.vecDecalInstance.begin() + layer.nDecalInstances;
+		auto best = first;
+		for (auto it = first + 1; it != layer.vecDecalInstance.end(); ++it)
+		{
+			size_t nBest = best->pos.capacity(), nCapacity = it->pos.capacity();
+			if (nBest < nPoints ? nCapacity > nBest : (nCapacity >= nPoints && nCapacity < nBest))
+				best = it;
+		}
+		std::swap(*first, *best);
+		layer.nDecalInstances++;
+		DecalInstance& di = *first;
+		di.decal = nullptr;
+		di.pos.clear();
+		di.uv.clear();
+		di.w.clear();
+		di.tint.clear();
+		di.mode = olc::DecalMode::NORMAL;
+		di.structure = olc::DecalStructure::FAN;
+		di.points = 0;
+		return di;
+	}
 
 	void PixelGameEngine::olc_UpdateMouseFocus(bool state)
 	{ bHasMouseFocus = state; }
@@ -3899,13 +4026,15 @@ namespace olc
 		renderer->ClearBuffer(olc::BLACK, true);
 
 		// Layer 0 must always exist
-		vLayers[0].bUpdate = true;
+		// BlockDrop: like other layers, layer 0 is only re-uploaded when
+		// marked dirty with SetDrawTarget(0, true)
 		vLayers[0].bShow = true;
 		SetDecalMode(DecalMode::NORMAL);
 		renderer->PrepareDrawing();
 
 		for (auto layer = vLayers.rbegin(); layer != vLayers.rend(); ++layer)
 		{
+			OLC_PROFILE_ZONE("olc layer");
 			if (layer->bShow)
 			{
 				if (layer->funcHook == nullptr)
@@ -3920,9 +4049,9 @@ namespace olc
 					renderer->DrawLayerQuad(layer->vOffset, layer->vScale, layer->tint);
 
 					// Display Decals in order for this layer
-					for (auto& decal : layer->vecDecalInstance)
-						renderer->DrawDecal(decal);
-					layer->vecDecalInstance.clear();
+					for (uint32_t i = 0; i < layer->nDecalInstances; i++)
+						renderer->DrawDecal(layer->vecDecalInstance[i]);
+					layer->nDecalInstances = 0;
 				}
 				else
 				{
@@ -3935,7 +4064,11 @@ namespace olc
 		
 
 		// Present Graphics to screen
-		renderer->DisplayFrame();
+		{
+			OLC_PROFILE_ZONE("olc present");
+			renderer->DisplayFrame();
+		}
+		OnFramePresented();
 
 		// Update Title Bar
 		fFrameTimer += fElapsedTime;
@@ -3944,7 +4077,10 @@ namespace olc
 		{
 			nLastFPS = nFrameCount;
 			fFrameTimer -= 1.0f;
-			std::string sTitle = "OneLoneCoder.com - Pixel Game Engine - " + sAppName + " - FPS: " + std::to_string(nFrameCount);
+			char sFPS[16];
+			std::snprintf(sFPS, sizeof(sFPS), "%d", nFrameCount);
+			sTitle.assign("OneLoneCoder.com - Pixel Game Engine - ");
+			sTitle.append(sAppName).append(" - FPS: ").append(sFPS);
 			platform->SetWindowTitle(sTitle);
 			nFrameCount = 0;
 		}
@@ -5222,6 +5358,9 @@ namespace olc
 // O------------------------------------------------------------------------------O
 #pragma endregion
 
+// BlockDrop: the libpng loader is also used by headless builds
+#endif // Headless
+
 #pragma region image_libpng
 // O------------------------------------------------------------------------------O
 // | START IMAGE LOADER: libpng, default on linux, requires -lpng  (libpng-dev)   |
@@ -5346,6 +5485,8 @@ namespace olc
 // O------------------------------------------------------------------------------O
 #pragma endregion
 
+#if !defined(OLC_PGE_HEADLESS)
+
 
 // O------------------------------------------------------------------------------O
 // | olcPixelGameEngine Platforms                                                 |
@@ -0,0 +1,134 @@
+// Runs the App headless for a fixed number of frames on scripted input and
+// reports how long each frame's OnUserUpdate() takes, overall and on each
+// screen. See AppHarness.h for how the script and end of game screens play.
+//
+//   app_benchmark [--frames N] [--seed N] [--replay FILE] [--max-p99 MS]
+//
+// With --max-p99 it fails if the overall p99 is slower, so it can gate
+// changes on end to end frame time.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "AppHarness.h"
+#include "Replay.h"
+#include "ToolArgs.h"
+
+using namespace BlockDrop;
+
+namespace
+{
+
+// Frame times in ms; Print() sorts them, which GetPercentile() needs
+struct FrameTimes
+{
+	std::vector<double> m_Ms;
+
+	double GetPercentile(double fraction) const
+	{
+		return m_Ms.empty() ? 0.0 : m_Ms[std::min(m_Ms.size() - 1, static_cast<size_t>(fraction * m_Ms.size()))];
+	}
+
+	void Print(char const* name)
+	{
+		std::sort(m_Ms.begin(), m_Ms.end());
+		double totalMs = 0.0;
+		for (double ms : m_Ms)
+		{
+			totalMs += ms;
+		}
+		std::printf("  %-16s %7zu frames  mean %.3f  p50 %.3f  p90 %.3f  p99 %.3f  max %.3f\n",
+			name, m_Ms.size(), m_Ms.empty() ? 0.0 : totalMs / m_Ms.size(),
+			GetPercentile(0.50), GetPercentile(0.90), GetPercentile(0.99), m_Ms.empty() ? 0.0 : m_Ms.back());
+	}
+};
+
+}
+
+int main(int argc, char** argv)
+{
+	size_t frameCount = 10000;
+	uint32_t seed = 1;
+	std::string replayPath;
+	double maxP99Ms = 0.0;
+
+	ToolArgs args(argc, argv);
+	while (args.Next())
+	{
+		if (args.Option("--frames"))
+		{
+			frameCount = std::max<size_t>(1, std::strtoull(args.GetValue(), nullptr, 10));
+		}
+		else if (args.Option("--seed"))
+		{
+			seed = static_cast<uint32_t>(std::strtoul(args.GetValue(), nullptr, 10));
+		}
+		else if (args.Option("--replay"))
+		{
+			replayPath = args.GetValue();
+		}
+		else if (args.Option("--max-p99"))
+		{
+			maxP99Ms = std::atof(args.GetValue());
+		}
+		else
+		{
+			args.SetError();
+		}
+	}
+	if (args.HasError())
+	{
+		std::fprintf(stderr, "usage: app_benchmark [--frames N] [--seed N] [--replay FILE] [--max-p99 MS]\n");
+		return 1;
+	}
+
+	Replay script;
+	if (replayPath.empty())
+	{
+		// A few games' worth, repeated as often as needed
+		script = Replay::MakeScripted(seed, 3600);
+	}
+	else if (!script.Load(replayPath))
+	{
+		std::fprintf(stderr, "Couldn't load %s\n", replayPath.c_str());
+		return 1;
+	}
+
+	AppHarness harness(script);
+	if (!harness.Start())
+	{
+		std::fprintf(stderr, "Couldn't start the app headless\n");
+		return 1;
+	}
+	if (!harness.Run(frameCount))
+	{
+		std::fprintf(stderr, "The app exited after %zu frames\n", harness.GetFrames().size());
+	}
+
+	FrameTimes all;
+	FrameTimes screens[3];
+	for (AppFrame const& frame : harness.GetFrames())
+	{
+		double ms = frame.m_UserUpdateSeconds * 1000.0;
+		all.m_Ms.push_back(ms);
+		screens[static_cast<int>(frame.m_UiState)].m_Ms.push_back(ms);
+	}
+
+	std::printf("%zu frames, %d games over, %d scores entered; OnUserUpdate ms:\n",
+		harness.GetFrames().size(), harness.GetGamesOver(), harness.GetScoresEntered());
+	all.Print("all");
+	screens[static_cast<int>(UiState::Game)].Print("game");
+	screens[static_cast<int>(UiState::GameOver)].Print("game over");
+	screens[static_cast<int>(UiState::ScoreboardEntry)].Print("scoreboard entry");
+
+	if (maxP99Ms > 0.0 && all.GetPercentile(0.99) > maxP99Ms)
+	{
+		std::fprintf(stderr, "p99 %.3f ms is over %.3f ms\n", all.GetPercentile(0.99), maxP99Ms);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,419 @@
+// Micro benchmarks of the Sim's hot paths and the score board, and macro
+// benchmarks of whole headless games and App frames. Writes JSON, one entry
+// per benchmark, so runs can be diffed for regressions.
+//
+//   benchmark_suite [--filter TEXT] [--min-time SECONDS] [--games N] [--frames N] [--out FILE]
+//
+// Micro benchmarks run in growing batches until one takes --min-time, a few
+// times over, and report the fastest batch's ns/op. TransferBlockToTiles
+// includes putting the board back each time, a copy of its 200 tiles.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Game.h"
+#include "HeadlessDriver.h"
+#include "Replay.h"
+#include "ScoreBoard.h"
+#include "Sim.h"
+#include "ToolArgs.h"
+
+namespace BlockDrop
+{
+
+// Sets up and calls Sim's private hot paths; a friend of Sim
+class SimBenchmark
+{
+public:
+	static constexpr int s_Width = App::s_BoardTileWidth;
+	static constexpr int s_Height = App::s_BoardTileHeight;
+
+public:
+	// Random tiles in the bottom rows, about one in four of them a hole
+	static void FillRubble(Sim& sim, int rows, std::mt19937& random)
+	{
+		for (int row = s_Height - rows; row < s_Height; ++row)
+		{
+			for (int col = 0; col < s_Width; ++col)
+			{
+				sim._At(row, col) = random() % 4 == 0 ? TileColor::None : TileColor::Green;
+			}
+		}
+	}
+
+	static bool HasCollision(Sim const& sim, TetronimoInstance const& tetronimo) { return sim.HasCollision(tetronimo); }
+	static bool TryWallKick(Sim const& sim, TetronimoInstance& tetronimo) { return sim.TryWallKick(tetronimo); }
+	static void TransferBlockToTiles(Sim& sim, TetronimoInstance const& tetronimo) { sim.TransferBlockToTiles(tetronimo); }
+	static void SetFallingBlock(Sim& sim, TetronimoInstance const& tetronimo) { sim.m_FallingBlock = tetronimo; }
+
+	// The bottom clearCount rows full but for column col, where a vertical I
+	// dropped into the bottom four rows clears them
+	static TetronimoInstance SetUpClears(Sim& sim, int clearCount, int col)
+	{
+		for (int row = s_Height - clearCount; row < s_Height; ++row)
+		{
+			for (int c = 0; c < s_Width; ++c)
+			{
+				sim._At(row, c) = c == col ? TileColor::None : TileColor::Blue;
+			}
+		}
+		TetronimoInstance block = TetronimoFactory::New(s_Height - 3, col, TileColor::Red);
+		block.Rotate(1);
+		return block;
+	}
+	static std::vector<TileColor>& GetTiles(Sim& sim) { return sim.m_Tiles; }
+	// Keeps the level and score from growing without bound over millions of
+	// clears
+	static void ResetScore(Sim& sim)
+	{
+		sim.m_Level = 1;
+		sim.m_RowsCleared = 0;
+		sim.m_Score = 0;
+		sim.m_Combo = -1;
+	}
+};
+
+}
+
+using namespace BlockDrop;
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int s_Repetitions = 5;
+constexpr size_t s_CandidateCount = 64;
+// Scripted games top out in well under this; it only stops one that doesn't
+constexpr size_t s_MaxUpdatesPerGame = 100000;
+
+// Results are added here so the work can't be optimised away
+volatile uint64_t s_Sink = 0;
+
+struct Result
+{
+	std::string m_Name;
+	double m_Value;
+	char const* m_Unit;
+	uint64_t m_Iterations;
+};
+
+struct Options
+{
+	std::string m_Filter;
+	double m_MinSeconds = 0.2;
+	int m_Games = 20;
+	size_t m_Frames = 3600;
+};
+
+bool Selected(Options const& options, char const* name)
+{
+	return options.m_Filter.empty() || std::string(name).find(options.m_Filter) != std::string::npos;
+}
+
+double SecondsSince(Clock::time_point start)
+{
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// fn(i) is one operation
+template <typename Fn>
+void RunMicro(std::vector<Result>& results, Options const& options, char const* name, Fn&& fn)
+{
+	if (!Selected(options, name))
+	{
+		return;
+	}
+
+	double bestNs = 0.0;
+	uint64_t totalIterations = 0;
+	for (int repetition = 0; repetition < s_Repetitions; ++repetition)
+	{
+		for (uint64_t batch = 64;; batch *= 2)
+		{
+			auto start = Clock::now();
+			for (uint64_t i = 0; i < batch; ++i)
+			{
+				fn(i);
+			}
+			double seconds = SecondsSince(start);
+			totalIterations += batch;
+			if (seconds >= options.m_MinSeconds)
+			{
+				double ns = seconds * 1e9 / batch;
+				bestNs = repetition == 0 ? ns : std::min(bestNs, ns);
+				break;
+			}
+		}
+	}
+	results.push_back({ name, bestNs, "ns/op", totalIterations });
+	std::fprintf(stderr, "%-40s %10.2f ns/op\n", name, bestNs);
+}
+
+std::vector<TetronimoInstance> MakeCandidates(std::mt19937& random, int minCol, int maxCol, int minRow, int maxRow)
+{
+	static constexpr std::array<TileColor, 7> s_Colors{
+		TileColor::Red, TileColor::Blue, TileColor::Cyan, TileColor::Magenta,
+		TileColor::Yellow, TileColor::Green, TileColor::Orange,
+	};
+	std::vector<TetronimoInstance> candidates;
+	for (size_t i = 0; i < s_CandidateCount; ++i)
+	{
+		int row = std::uniform_int_distribution<int>(minRow, maxRow)(random);
+		int col = std::uniform_int_distribution<int>(minCol, maxCol)(random);
+		TetronimoInstance candidate = TetronimoFactory::New(row, col, s_Colors[random() % s_Colors.size()]);
+		candidate.Rotate(static_cast<int>(random() % 4));
+		candidates.push_back(candidate);
+	}
+	return candidates;
+}
+
+void RunSimMicro(std::vector<Result>& results, Options const& options)
+{
+	constexpr int w = SimBenchmark::s_Width;
+	constexpr int h = SimBenchmark::s_Height;
+	std::mt19937 random(1);
+
+	Sim rubble(w, h, 1);
+	SimBenchmark::FillRubble(rubble, h / 2, random);
+
+	auto anywhere = MakeCandidates(random, -1, w, 0, h - 1);
+	RunMicro(results, options, "Sim::HasCollision", [&](uint64_t i) {
+		s_Sink = s_Sink + SimBenchmark::HasCollision(rubble, anywhere[i % s_CandidateCount]);
+	});
+
+	// Beside the walls and low in the rubble, where rotations need kicks
+	auto nearWalls = MakeCandidates(random, 0, 1, h / 2 - 2, h - 3);
+	auto nearRightWall = MakeCandidates(random, w - 2, w - 1, h / 2 - 2, h - 3);
+	nearWalls.insert(nearWalls.end(), nearRightWall.begin(), nearRightWall.end());
+	RunMicro(results, options, "Sim::TryWallKick", [&](uint64_t i) {
+		TetronimoInstance kicked = nearWalls[i % nearWalls.size()];
+		s_Sink = s_Sink + SimBenchmark::TryWallKick(rubble, kicked);
+	});
+
+	static constexpr std::array<char const*, 5> s_TransferNames{
+		"Sim::TransferBlockToTiles/0 clears",
+		"Sim::TransferBlockToTiles/1 clear",
+		"Sim::TransferBlockToTiles/2 clears",
+		"Sim::TransferBlockToTiles/3 clears",
+		"Sim::TransferBlockToTiles/4 clears",
+	};
+	for (int clears = 0; clears <= 4; ++clears)
+	{
+		Sim sim(w, h, 1);
+		TetronimoInstance block = SimBenchmark::SetUpClears(sim, clears, w / 2);
+		std::vector<TileColor> const board = SimBenchmark::GetTiles(sim);
+		RunMicro(results, options, s_TransferNames[clears], [&](uint64_t) {
+			SimBenchmark::TransferBlockToTiles(sim, block);
+			std::copy(board.begin(), board.end(), SimBenchmark::GetTiles(sim).begin());
+			SimBenchmark::ResetScore(sim);
+			sim.ClearChanges();
+		});
+	}
+
+	auto spawns = MakeCandidates(random, 1, w - 2, 0, 1);
+	RunMicro(results, options, "Sim::GetDropPosition", [&](uint64_t i) {
+		SimBenchmark::SetFallingBlock(rubble, spawns[i % s_CandidateCount]);
+		s_Sink = s_Sink + rubble.GetDropPosition().y;
+	});
+
+	Sim bag(w, h, 1);
+	RunMicro(results, options, "Sim::GetNextBlockColor", [&](uint64_t) {
+		s_Sink = s_Sink + static_cast<uint64_t>(bag.GetNextBlockColor());
+	});
+	// Refills and shuffles the bag every seven
+	RunMicro(results, options, "Sim::PopNextBlockColor", [&](uint64_t) {
+		s_Sink = s_Sink + static_cast<uint64_t>(bag.PopNextBlockColor());
+	});
+}
+
+void RunScoreBoardMicro(std::vector<Result>& results, Options const& options)
+{
+	ScoreList scores;
+	for (int i = 1; i <= 10; ++i)
+	{
+		scores.emplace_back("AAA", i * 100, i);
+	}
+	ScoreBoard board(scores);
+	std::string const name = "ZZZ";
+	RunMicro(results, options, "ScoreBoard::SetScore", [&](uint64_t i) {
+		board.SetScore(name, static_cast<int>(i % 2000), 1);
+	});
+}
+
+// Sims on their own, no drawing, each playing a scripted game to the end or
+// s_MaxUpdatesPerGame. Games stopped there are reported, as games/s no longer
+// compares between builds.
+void RunGames(std::vector<Result>& results, Options const& options)
+{
+	char const* name = "Sim games";
+	if (!Selected(options, name))
+	{
+		return;
+	}
+
+	uint64_t updates = 0;
+	int cappedGames = 0;
+	auto start = Clock::now();
+	for (int game = 0; game < options.m_Games; ++game)
+	{
+		uint32_t seed = static_cast<uint32_t>(game + 1);
+		Replay script = Replay::MakeScripted(seed, options.m_Frames);
+		Sim sim(SimBenchmark::s_Width, SimBenchmark::s_Height, seed);
+		ReplayKeys previousKeys{};
+		for (size_t frame = 0; !sim.IsGameOver() && frame < s_MaxUpdatesPerGame; ++frame)
+		{
+			ReplayKeys keys = script.GetKeys(frame % script.GetFrameCount());
+			sim.Update(script.GetFrameTime(), InputFromKeys(keys, previousKeys));
+			sim.ClearChanges();
+			previousKeys = keys;
+			updates++;
+		}
+		cappedGames += !sim.IsGameOver();
+	}
+	double seconds = SecondsSince(start);
+
+	double gamesPerSecond = options.m_Games / seconds;
+	results.push_back({ name, gamesPerSecond, "games/s", static_cast<uint64_t>(options.m_Games) });
+	results.push_back({ "Sim games/updates", updates / seconds, "updates/s", updates });
+	results.push_back({ "Sim games/capped", static_cast<double>(cappedGames), "games", static_cast<uint64_t>(options.m_Games) });
+	std::fprintf(stderr, "%-40s %10.1f games/s (%.0f updates/s)\n", name, gamesPerSecond, updates / seconds);
+	if (cappedGames > 0)
+	{
+		std::fprintf(stderr, "%d of %d games didn't end within %zu updates\n", cappedGames, options.m_Games, s_MaxUpdatesPerGame);
+	}
+}
+
+// Whole headless App frames: input, Sim, drawing and rasterizing. Returns
+// false if the App couldn't start.
+bool RunAppFrames(std::vector<Result>& results, Options const& options)
+{
+	char const* name = "App frames";
+	if (!Selected(options, name))
+	{
+		return true;
+	}
+
+	Replay replay = Replay::MakeScripted(1, options.m_Frames);
+	App app(replay.GetSeed());
+	HeadlessDriver driver;
+	if (!driver.Start(App::ScreenWidthPx, App::s_ScreenHeightPx))
+	{
+		std::fprintf(stderr, "Couldn't start the game headless\n");
+		return false;
+	}
+
+	std::vector<double> frameMs;
+	frameMs.reserve(replay.GetFrameCount());
+	for (size_t frame = 0; frame < replay.GetFrameCount(); ++frame)
+	{
+		driver.SetKeys(replay.GetKeys(frame));
+		auto start = Clock::now();
+		bool bRunning = driver.Step(replay.GetFrameTime());
+		frameMs.push_back(SecondsSince(start) * 1000.0);
+		if (!bRunning)
+		{
+			break;
+		}
+	}
+
+	double totalMs = 0.0;
+	for (double ms : frameMs)
+	{
+		totalMs += ms;
+	}
+	std::sort(frameMs.begin(), frameMs.end());
+	auto percentile = [&](double p) { return frameMs[std::min(frameMs.size() - 1, static_cast<size_t>(p * frameMs.size()))]; };
+
+	uint64_t frames = frameMs.size();
+	double framesPerSecond = frames * 1000.0 / totalMs;
+	results.push_back({ name, framesPerSecond, "frames/s", frames });
+	results.push_back({ "App frames/p50", percentile(0.5), "ms", frames });
+	results.push_back({ "App frames/p99", percentile(0.99), "ms", frames });
+	std::fprintf(stderr, "%-40s %10.0f frames/s (p50 %.3f ms, p99 %.3f ms)\n",
+		name, framesPerSecond, percentile(0.5), percentile(0.99));
+	return true;
+}
+
+bool WriteJson(FILE* file, std::vector<Result> const& results)
+{
+	std::fprintf(file, "{\n  \"benchmarks\": [");
+	char const* separator = "";
+	for (Result const& result : results)
+	{
+		std::fprintf(file, "%s\n    {\"name\": \"%s\", \"value\": %.6g, \"unit\": \"%s\", \"iterations\": %llu}",
+			separator, result.m_Name.c_str(), result.m_Value, result.m_Unit,
+			static_cast<unsigned long long>(result.m_Iterations));
+		separator = ",";
+	}
+	std::fprintf(file, "\n  ]\n}\n");
+	return std::ferror(file) == 0;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+	std::string outPath;
+
+	ToolArgs args(argc, argv);
+	while (args.Next())
+	{
+		if (args.Option("--filter"))
+		{
+			options.m_Filter = args.GetValue();
+		}
+		else if (args.Option("--min-time"))
+		{
+			options.m_MinSeconds = std::clamp(std::atof(args.GetValue()), 0.001, 10.0);
+		}
+		else if (args.Option("--games"))
+		{
+			options.m_Games = std::max(1, std::atoi(args.GetValue()));
+		}
+		else if (args.Option("--frames"))
+		{
+			options.m_Frames = std::max<size_t>(1, std::strtoull(args.GetValue(), nullptr, 10));
+		}
+		else if (args.Option("--out"))
+		{
+			outPath = args.GetValue();
+		}
+		else
+		{
+			args.SetError();
+		}
+	}
+	if (args.HasError())
+	{
+		std::fprintf(stderr, "usage: benchmark_suite [--filter TEXT] [--min-time SECONDS] [--games N] [--frames N] [--out FILE]\n");
+		return 1;
+	}
+	std::vector<Result> results;
+	RunSimMicro(results, options);
+	RunScoreBoardMicro(results, options);
+	RunGames(results, options);
+	if (!RunAppFrames(results, options))
+	{
+		return 1;
+	}
+
+	if (outPath.empty())
+	{
+		return WriteJson(stdout, results) ? 0 : 1;
+	}
+	FILE* file = std::fopen(outPath.c_str(), "w");
+	if (file == nullptr || !WriteJson(file, results) || std::fclose(file) != 0)
+	{
+		std::fprintf(stderr, "Couldn't write %s\n", outPath.c_str());
+		return 1;
+	}
+	return 0;
+}
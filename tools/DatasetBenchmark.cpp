@@ -0,0 +1,148 @@
+// Samples random batches from dataset shards, as a trainer would, and reports
+// samples/sec for 1..N threads sharing one DatasetReader.
+//
+//   dataset_benchmark [--threads N] [--batch N] [--seconds S] PREFIX
+//
+// Reads PREFIX-00000.bds, PREFIX-00001.bds, ... as written by dataset_export.
+// The shards are pulled into the page cache first, so this measures decoding
+// and memory, not disk.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Dataset.h"
+#include "DatasetReader.h"
+#include "ToolArgs.h"
+
+using namespace BlockDrop;
+
+namespace
+{
+
+void PrintUsage()
+{
+	std::fprintf(stderr, "usage: dataset_benchmark [--threads N] [--batch N] [--seconds S] PREFIX\n");
+}
+
+// Samples per second across threadCount threads, each drawing batches until
+// the time is up
+double MeasureSampling(DatasetReader const& reader, int threadCount, size_t batchSize, double seconds, bool& bShort)
+{
+	using Clock = std::chrono::steady_clock;
+	std::atomic<bool> bStop{ false };
+	std::atomic<uint64_t> samples{};
+	std::atomic<bool> bAnyShort{ false };
+
+	auto start = Clock::now();
+	std::vector<std::thread> threads;
+	for (int t = 0; t < threadCount; ++t)
+	{
+		threads.emplace_back([&, t] {
+			std::mt19937_64 rng(t + 1);
+			std::vector<DatasetRecord> batch(batchSize);
+			uint64_t count = 0;
+			while (!bStop.load(std::memory_order_relaxed))
+			{
+				size_t decoded = reader.SampleBatch(batch.data(), batchSize, rng);
+				bAnyShort = bAnyShort || decoded != batchSize;
+				count += decoded;
+			}
+			samples += count;
+		});
+	}
+
+	std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+	bStop = true;
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+	double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+	bShort = bAnyShort;
+	return samples / elapsed;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+	int maxThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+	size_t batchSize = 1024;
+	double seconds = 2.0;
+	std::string prefix;
+
+	ToolArgs args(argc, argv);
+	while (args.Next())
+	{
+		if (args.Option("--threads"))
+		{
+			maxThreads = std::clamp(std::atoi(args.GetValue()), 1, 64);
+		}
+		else if (args.Option("--batch"))
+		{
+			batchSize = std::max<size_t>(1, std::strtoull(args.GetValue(), nullptr, 10));
+		}
+		else if (args.Option("--seconds"))
+		{
+			seconds = std::clamp(std::atof(args.GetValue()), 0.1, 600.0);
+		}
+		else if (args.IsPositional() && prefix.empty())
+		{
+			prefix = args.Get();
+		}
+		else
+		{
+			args.SetError();
+		}
+	}
+	if (args.HasError() || prefix.empty())
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	DatasetReader reader;
+	char suffix[16];
+	for (int shard = 0;; ++shard)
+	{
+		std::snprintf(suffix, sizeof(suffix), "-%05d", shard);
+		if (!reader.AddShard(prefix + suffix + s_DatasetShardExtension))
+		{
+			break;
+		}
+	}
+	if (reader.GetRecordCount() == 0)
+	{
+		std::fprintf(stderr, "No records in %s-*%s; write some with dataset_export\n", prefix.c_str(), s_DatasetShardExtension);
+		return 1;
+	}
+	reader.WarmPageCache();
+
+	std::printf("%llu records in %d shards, batches of %zu\n",
+		static_cast<unsigned long long>(reader.GetRecordCount()), reader.GetShardCount(), batchSize);
+	for (int threadCount = 1; threadCount <= maxThreads; threadCount *= 2)
+	{
+		bool bShort = false;
+		double samplesPerSecond = MeasureSampling(reader, threadCount, batchSize, seconds, bShort);
+		std::printf("  %2d threads: %8.2f M samples/sec\n", threadCount, samplesPerSecond / 1e6);
+		if (bShort)
+		{
+			std::fprintf(stderr, "Some records didn't decode; the shards are corrupt\n");
+			return 1;
+		}
+		if (threadCount < maxThreads && threadCount * 2 > maxThreads)
+		{
+			threadCount = maxThreads / 2;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,231 @@
+// Plays scripted games headless on several threads, records every placement
+// to dataset shards with DatasetWriter, then reads the shards back with
+// DatasetReader and checks they hold exactly what was recorded.
+//
+//   dataset_export [--games N] [--threads N] [--seed N] [--shard-mb N] PREFIX
+//
+// Shards are written as PREFIX-00000.bds, PREFIX-00001.bds, ... Game N of the
+// run plays the scripted game for seed + N, whichever thread it lands on.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Dataset.h"
+#include "DatasetReader.h"
+#include "DatasetWriter.h"
+#include "Game.h"
+#include "PackedBoard.h"
+#include "Replay.h"
+#include "Sim.h"
+#include "ToolArgs.h"
+
+using namespace BlockDrop;
+
+namespace
+{
+
+// Scripted games top out in well under this; it only stops one that doesn't
+constexpr size_t s_MaxUpdatesPerGame = 100000;
+
+void PrintUsage()
+{
+	std::fprintf(stderr, "usage: dataset_export [--games N] [--threads N] [--seed N] [--shard-mb N] PREFIX\n");
+}
+
+// Order-independent summary of a set of records, to compare what was written
+// with what was read back
+struct RecordChecksum
+{
+	uint64_t m_Count{};
+	uint64_t m_Sum{};
+
+	void Add(DatasetRecord const& record)
+	{
+		// FNV-1a over the record's bytes, summed so order doesn't matter
+		uint8_t bytes[sizeof(DatasetRecord)];
+		std::memcpy(bytes, &record, sizeof(bytes));
+		uint64_t hash = 14695981039346656037ull;
+		for (uint8_t byte : bytes)
+		{
+			hash = (hash ^ byte) * 1099511628211ull;
+		}
+		m_Count++;
+		m_Sum += hash;
+	}
+
+	bool operator==(RecordChecksum const& other) const = default;
+};
+
+// Plays one scripted game to the end, adding a record for every block placed
+void RecordGame(uint32_t seed, DatasetWriter::Producer& producer, RecordChecksum& checksum, std::vector<DatasetRecord>& game)
+{
+	Replay script = Replay::MakeScripted(seed, 3600);
+	Sim sim(App::s_BoardTileWidth, App::s_BoardTileHeight, seed);
+	ReplayKeys previousKeys{};
+	int spawnScore = 0;
+	game.clear();
+
+	for (size_t update = 0; !sim.IsGameOver() && update < s_MaxUpdatesPerGame; ++update)
+	{
+		PackedBoard board(sim);
+		int placedCount = sim.GetPlacedBlockCount();
+		bool bHadBlock = sim.GetFallingBlock().has_value();
+
+		ReplayKeys keys = script.GetKeys(update % script.GetFrameCount());
+		sim.Update(script.GetFrameTime(), InputFromKeys(keys, previousKeys));
+		sim.ClearChanges();
+		previousKeys = keys;
+
+		if (sim.GetPlacedBlockCount() != placedCount)
+		{
+			DatasetRecord record = MakeDatasetRecord(board, sim.GetLastPlacedBlock().value(), spawnScore);
+			producer.Add(record);
+			game.push_back(record);
+		}
+		if (!bHadBlock && sim.GetFallingBlock().has_value())
+		{
+			spawnScore = sim.GetScore();
+		}
+	}
+
+	producer.EndGame(sim.GetScore());
+	for (DatasetRecord& record : game)
+	{
+		record.m_FinalScore = sim.GetScore();
+		checksum.Add(record);
+	}
+}
+
+}
+
+int main(int argc, char** argv)
+{
+	int gameCount = 200;
+	int threadCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+	uint32_t seed = 1;
+	size_t shardSizeBytes = DatasetWriter::s_DefaultShardSizeBytes;
+	std::string prefix;
+
+	ToolArgs args(argc, argv);
+	while (args.Next())
+	{
+		if (args.Option("--games"))
+		{
+			gameCount = std::max(1, std::atoi(args.GetValue()));
+		}
+		else if (args.Option("--threads"))
+		{
+			threadCount = std::clamp(std::atoi(args.GetValue()), 1, 64);
+		}
+		else if (args.Option("--seed"))
+		{
+			seed = static_cast<uint32_t>(std::strtoul(args.GetValue(), nullptr, 10));
+		}
+		else if (args.Option("--shard-mb"))
+		{
+			shardSizeBytes = std::max<size_t>(1, std::strtoull(args.GetValue(), nullptr, 10)) << 20;
+		}
+		else if (args.IsPositional() && prefix.empty())
+		{
+			prefix = args.Get();
+		}
+		else
+		{
+			args.SetError();
+		}
+	}
+	if (args.HasError() || prefix.empty())
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	using Clock = std::chrono::steady_clock;
+	auto start = Clock::now();
+
+	std::vector<RecordChecksum> checksums(threadCount);
+	std::atomic<int> nextGame{};
+	uint64_t recordsWritten = 0;
+	int shardCount = 0;
+	{
+		DatasetWriter writer(prefix, shardSizeBytes);
+		std::vector<std::thread> threads;
+		for (int t = 0; t < threadCount; ++t)
+		{
+			threads.emplace_back([&, t] {
+				DatasetWriter::Producer producer(writer);
+				std::vector<DatasetRecord> game;
+				for (int g = nextGame++; g < gameCount; g = nextGame++)
+				{
+					RecordGame(seed + g, producer, checksums[t], game);
+				}
+			});
+		}
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+		if (!writer.Close())
+		{
+			std::fprintf(stderr, "%s\n", writer.GetError().c_str());
+			return 1;
+		}
+		recordsWritten = writer.GetRecordsWritten();
+		shardCount = writer.GetShardCount();
+	}
+	double writeSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+	RecordChecksum expected;
+	for (RecordChecksum const& checksum : checksums)
+	{
+		expected.m_Count += checksum.m_Count;
+		expected.m_Sum += checksum.m_Sum;
+	}
+	std::printf("%d games, %llu records in %d shards, %.2f s\n", gameCount,
+		static_cast<unsigned long long>(recordsWritten), shardCount, writeSeconds);
+
+	// Read every record back
+	DatasetReader reader;
+	char suffix[16];
+	for (int shard = 0; shard < shardCount; ++shard)
+	{
+		std::snprintf(suffix, sizeof(suffix), "-%05d", shard);
+		std::string path = prefix + suffix + s_DatasetShardExtension;
+		if (!reader.AddShard(path))
+		{
+			std::fprintf(stderr, "Couldn't read shard %s\n", path.c_str());
+			return 1;
+		}
+	}
+
+	RecordChecksum actual;
+	uint64_t badFinalScores = 0;
+	for (uint64_t i = 0; i < reader.GetRecordCount(); ++i)
+	{
+		DatasetRecord record{};
+		if (!reader.Read(i, record))
+		{
+			std::fprintf(stderr, "Couldn't decode record %llu\n", static_cast<unsigned long long>(i));
+			return 1;
+		}
+		badFinalScores += record.m_FinalScore < record.m_Score;
+		actual.Add(record);
+	}
+
+	if (!(actual == expected) || badFinalScores > 0)
+	{
+		std::fprintf(stderr, "Read back %llu records, expected %llu; checksums %s, %llu final scores below the score\n",
+			static_cast<unsigned long long>(actual.m_Count), static_cast<unsigned long long>(expected.m_Count),
+			actual.m_Sum == expected.m_Sum ? "match" : "differ", static_cast<unsigned long long>(badFinalScores));
+		return 1;
+	}
+	std::printf("Read back and checked %llu records\n", static_cast<unsigned long long>(actual.m_Count));
+	return 0;
+}
@@ -0,0 +1,122 @@
+// Measures fill rate of the engine's CPU drawing routines in megapixels/sec,
+// against a Draw() per pixel as FillRect used to do.
+//
+//   fill_benchmark [--megapixels N]
+//
+// Each case draws at least N megapixels (default 500) into a 480x640 layer.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "olcPixelGameEngine.h"
+
+#include "Game.h"
+#include "HeadlessDriver.h"
+#include "ToolArgs.h"
+
+using namespace BlockDrop;
+
+namespace
+{
+
+class FillEngine : public olc::PixelGameEngine
+{
+public:
+	bool OnUserCreate() override { return true; }
+	bool OnUserUpdate(float) override { return true; }
+};
+
+// Calls draw(color) until pixelsPerCall * calls reaches targetPixels and
+// returns megapixels/sec
+template <typename Fn>
+double Measure(double targetPixels, int64_t pixelsPerCall, Fn&& draw)
+{
+	int64_t calls = std::max<int64_t>(1, static_cast<int64_t>(targetPixels / pixelsPerCall));
+
+	using Clock = std::chrono::steady_clock;
+	auto start = Clock::now();
+	for (int64_t i = 0; i < calls; ++i)
+	{
+		draw(olc::Pixel(static_cast<uint8_t>(i), 0x40, 0x80));
+	}
+	double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+	return static_cast<double>(calls * pixelsPerCall) / seconds / 1e6;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+	double megapixels = 500;
+	ToolArgs args(argc, argv);
+	while (args.Next())
+	{
+		if (args.Option("--megapixels"))
+		{
+			megapixels = std::max(1.0, std::atof(args.GetValue()));
+		}
+		else
+		{
+			args.SetError();
+		}
+	}
+	if (args.HasError())
+	{
+		std::fprintf(stderr, "usage: fill_benchmark [--megapixels N]\n");
+		return 1;
+	}
+
+	FillEngine engine;
+	HeadlessDriver driver;
+	if (!driver.Start(App::ScreenWidthPx, App::s_ScreenHeightPx))
+	{
+		std::fprintf(stderr, "Couldn't start the engine headless\n");
+		return 1;
+	}
+
+	double target = megapixels * 1e6;
+	int32_t const screenW = App::ScreenWidthPx;
+	int32_t const screenH = App::s_ScreenHeightPx;
+	int32_t const boardW = App::s_BoardTileWidthPx;
+	int32_t const boardH = App::s_BoardTileHeightPx;
+	int32_t const tile = App::s_TileSizePx;
+
+	struct Case
+	{
+		char const* m_Name;
+		double m_MPs;
+	};
+	Case const cases[] = {
+		{ "Draw() per pixel, board", Measure(target, int64_t(boardW) * boardH, [&](olc::Pixel p) {
+			// FillRect's loop before the span path
+			for (int x = App::s_BoardLeft; x < App::s_BoardLeft + boardW; ++x)
+				for (int y = App::s_UiTop; y < App::s_UiTop + boardH; ++y)
+					engine.Draw(x, y, p);
+		}) },
+		{ "Clear", Measure(target, int64_t(screenW) * screenH, [&](olc::Pixel p) {
+			engine.Clear(p);
+		}) },
+		{ "FillRect, board", Measure(target, int64_t(boardW) * boardH, [&](olc::Pixel p) {
+			engine.FillRect(App::s_BoardLeft, App::s_UiTop, boardW, boardH, p);
+		}) },
+		{ "FillRect, tile", Measure(target, int64_t(tile) * tile, [&](olc::Pixel p) {
+			engine.FillRect(App::s_BoardLeft, App::s_UiTop, tile, tile, p);
+		}) },
+		{ "DrawLine, horizontal", Measure(target, boardW + 1, [&](olc::Pixel p) {
+			engine.DrawLine(App::s_BoardLeft, App::s_UiTop, App::s_BoardLeft + boardW, App::s_UiTop, p);
+		}) },
+		{ "DrawRect, board", Measure(target, 2 * int64_t(boardW + boardH), [&](olc::Pixel p) {
+			engine.DrawRect(App::s_BoardLeft, App::s_UiTop, boardW, boardH, p);
+		}) },
+	};
+
+	std::printf("%-24s %10s\n", "case", "MP/s");
+	for (Case const& c : cases)
+	{
+		std::printf("%-24s %10.0f\n", c.m_Name, c.m_MPs);
+	}
+
+	return 0;
+}
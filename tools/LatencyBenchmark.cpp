@@ -0,0 +1,128 @@
+// Plays a scripted game headless in real time, with the Sim on its own thread
+// as in the game, and reports how long key presses take to show on screen.
+//
+//   latency_benchmark [--frames N] [--fps N] [--seed N] [--out FILE]
+//
+// Each frame's keys change at a random point before it starts, as they would
+// from a player, and are measured from then to the first frame presented
+// after the Sim steps them. At game over, Enter is tapped to start the next
+// game, so the whole run is play. --out writes the histogram as TSV.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+
+#include "Game.h"
+#include "HeadlessDriver.h"
+#include "Replay.h"
+#include "ToolArgs.h"
+
+using namespace BlockDrop;
+
+int main(int argc, char** argv)
+{
+	size_t frameCount = 3600;
+	double fps = 60.0;
+	uint32_t seed = 1;
+	std::string outPath;
+
+	ToolArgs args(argc, argv);
+	while (args.Next())
+	{
+		if (args.Option("--frames"))
+		{
+			frameCount = std::max<size_t>(1, std::strtoull(args.GetValue(), nullptr, 10));
+		}
+		else if (args.Option("--fps"))
+		{
+			fps = std::clamp(std::atof(args.GetValue()), 1.0, 1000.0);
+		}
+		else if (args.Option("--seed"))
+		{
+			seed = static_cast<uint32_t>(std::strtoul(args.GetValue(), nullptr, 10));
+		}
+		else if (args.Option("--out"))
+		{
+			outPath = args.GetValue();
+		}
+		else
+		{
+			args.SetError();
+		}
+	}
+	if (args.HasError())
+	{
+		std::fprintf(stderr, "usage: latency_benchmark [--frames N] [--fps N] [--seed N] [--out FILE]\n");
+		return 1;
+	}
+
+	App app(seed, true);
+	HeadlessDriver driver;
+	if (!driver.Start(App::ScreenWidthPx, App::s_ScreenHeightPx))
+	{
+		std::fprintf(stderr, "Couldn't start the app headless\n");
+		return 1;
+	}
+
+	using Clock = std::chrono::steady_clock;
+	auto frameTime = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / fps));
+	std::mt19937 random(seed);
+	std::uniform_int_distribution<Clock::rep> keyOffset(0, frameTime.count());
+
+	// Only these keys reach the Sim, and only their presses are measured
+	ReplayKeys const gameKeys = ReplayKeyBit(olc::LEFT) | ReplayKeyBit(olc::RIGHT) | ReplayKeyBit(olc::UP)
+		| ReplayKeyBit(olc::DOWN) | ReplayKeyBit(olc::SPACE) | ReplayKeyBit(olc::Q) | ReplayKeyBit(olc::E);
+
+	Replay script = Replay::MakeScripted(seed, frameCount);
+	size_t playFrame = 0;
+	ReplayKeys previousKeys = 0;
+	int gamesOver = 0;
+	uint64_t pressesSent = 0;
+	auto frameStart = Clock::now();
+	for (size_t frame = 0; frame < frameCount; ++frame)
+	{
+		// Past game over, tap Enter until the next game starts; the seeded App
+		// keeps scores in memory, so a scoreboard entry takes the default name
+		ReplayKeys keys = 0;
+		if (app.GetUiState() == UiState::Game)
+		{
+			keys = script.GetKeys(playFrame++ % script.GetFrameCount());
+		}
+		else if (!(previousKeys & ReplayKeyBit(olc::ENTER)))
+		{
+			keys = ReplayKeyBit(olc::ENTER);
+		}
+		gamesOver += app.GetUiState() == UiState::GameOver && (keys & ReplayKeyBit(olc::ENTER));
+
+		frameStart += frameTime;
+		std::this_thread::sleep_until(frameStart - Clock::duration(keyOffset(random)));
+		driver.SetKeys(keys);
+		std::this_thread::sleep_until(frameStart);
+		driver.Step(static_cast<float>(1.0 / fps));
+
+		for (ReplayKeys pressed = keys & ~previousKeys & gameKeys; pressed != 0; pressed &= pressed - 1)
+		{
+			pressesSent++;
+		}
+		previousKeys = keys;
+	}
+
+	LatencyHistogram const& latency = app.GetInputLatency();
+	std::printf("%zu frames at %.0f fps, %d games over\n", frameCount, fps, gamesOver);
+	std::printf("  %llu presses sent, %llu measured (percentiles over the last %d)\n",
+		static_cast<unsigned long long>(pressesSent), static_cast<unsigned long long>(latency.GetTotalCount()), latency.GetCount());
+	std::printf("  press to present ms: p50 %.2f  p95 %.2f  p99 %.2f\n",
+		latency.GetPercentile(0.50) * 1000.0, latency.GetPercentile(0.95) * 1000.0, latency.GetPercentile(0.99) * 1000.0);
+
+	if (!outPath.empty() && !latency.Save(outPath))
+	{
+		std::fprintf(stderr, "Couldn't write %s\n", outPath.c_str());
+		return 1;
+	}
+
+	return 0;
+}
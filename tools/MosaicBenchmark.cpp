@@ -0,0 +1,124 @@
+// Runs the mosaic spectator view headless with every board playing a scripted
+// game at full speed, and reports frames/sec and the slowest frames against
+// the 60 fps budget.
+//
+//   mosaic_benchmark [--boards N] [--frames N] [--seed N] [--save FILE]
+//
+// --save writes the last frame as a PPM. Builds with BLOCKDROP_SIM_COUNTERS
+// also report what the boards' Sims did.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "HeadlessDriver.h"
+#include "Mosaic.h"
+#include "SimCounters.h"
+#include "ToolArgs.h"
+
+using namespace BlockDrop;
+
+namespace
+{
+
+bool SavePpm(std::string const& path, olc::Pixel const* pixels, olc::vi2d size)
+{
+	FILE* file = std::fopen(path.c_str(), "wb");
+	if (file == nullptr)
+	{
+		return false;
+	}
+	std::fprintf(file, "P6\n%d %d\n255\n", size.x, size.y);
+	for (int i = 0; i < size.x * size.y; ++i)
+	{
+		uint8_t rgb[3]{ pixels[i].r, pixels[i].g, pixels[i].b };
+		std::fwrite(rgb, 1, 3, file);
+	}
+	return std::fclose(file) == 0;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+	int boardCount = Mosaic::s_MaxBoards;
+	size_t frameCount = 3600;
+	uint32_t seed = 1;
+	std::string savePath;
+
+	ToolArgs args(argc, argv);
+	while (args.Next())
+	{
+		if (args.Option("--boards"))
+		{
+			boardCount = std::atoi(args.GetValue());
+		}
+		else if (args.Option("--frames"))
+		{
+			frameCount = std::max<size_t>(1, std::strtoull(args.GetValue(), nullptr, 10));
+		}
+		else if (args.Option("--seed"))
+		{
+			seed = static_cast<uint32_t>(std::strtoul(args.GetValue(), nullptr, 10));
+		}
+		else if (args.Option("--save"))
+		{
+			savePath = args.GetValue();
+		}
+		else
+		{
+			args.SetError();
+		}
+	}
+	if (args.HasError())
+	{
+		std::fprintf(stderr, "usage: mosaic_benchmark [--boards N] [--frames N] [--seed N] [--save FILE]\n");
+		return 1;
+	}
+
+	Mosaic mosaic(boardCount, seed);
+	HeadlessDriver driver;
+	if (!driver.Start(Mosaic::s_ScreenWidthPx, Mosaic::s_ScreenHeightPx))
+	{
+		std::fprintf(stderr, "Couldn't start the mosaic headless\n");
+		return 1;
+	}
+
+	using Clock = std::chrono::steady_clock;
+	std::vector<double> frameMs;
+	frameMs.reserve(frameCount);
+	for (size_t frame = 0; frame < frameCount; ++frame)
+	{
+		auto start = Clock::now();
+		driver.Step(Replay::s_DefaultFrameTime);
+		frameMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+	}
+
+	double totalMs = 0;
+	for (double ms : frameMs)
+	{
+		totalMs += ms;
+	}
+	std::sort(frameMs.begin(), frameMs.end());
+	auto percentile = [&](double p) { return frameMs[std::min(frameMs.size() - 1, static_cast<size_t>(p * frameMs.size()))]; };
+
+	std::printf("%d boards, %d px tiles, %zu frames at %dx%d\n", mosaic.GetBoardCount(), mosaic.GetTileSize(),
+		frameCount, Mosaic::s_ScreenWidthPx, Mosaic::s_ScreenHeightPx);
+	std::printf("  %.0f frames/s, %d games played\n", frameCount * 1000.0 / totalMs, mosaic.GetGamesPlayed());
+	std::printf("  frame ms: p50 %.3f  p99 %.3f  max %.3f  (60 fps budget 16.667)\n",
+		percentile(0.5), percentile(0.99), frameMs.back());
+#if defined(BLOCKDROP_SIM_COUNTERS)
+	SimCounters::Read().Print(stdout);
+#endif
+
+	if (!savePath.empty() && !SavePpm(savePath, driver.GetFrame(), driver.GetFrameSize()))
+	{
+		std::fprintf(stderr, "Couldn't write %s\n", savePath.c_str());
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,283 @@
+// Exercises PositionDatabase the way self-play workers use it: several threads
+// record the same positions at once while another looks them up, then the
+// database is closed, reopened and every position's visit count, mean and
+// best placement are checked. Also checks that files which aren't databases
+// are refused without being touched.
+//
+//   position_database_check [--threads N] [--positions N] [--repeats N] [--path FILE]
+//
+// The database and the scratch files next to it are deleted afterwards.
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "PackedBoard.h"
+#include "PositionDatabase.h"
+#include "ToolArgs.h"
+
+using namespace BlockDrop;
+
+namespace
+{
+
+void PrintUsage()
+{
+	std::fprintf(stderr, "usage: position_database_check [--threads N] [--positions N] [--repeats N] [--path FILE]\n");
+}
+
+struct Position
+{
+	PackedBoard m_Board;
+	TileColor m_Piece{};
+};
+
+// What thread t records for position i, every time. Distinct for up to 1000
+// threads, so each position has one best.
+int FutureScore(int t, int i)
+{
+	return (i * 7 + t * 13) % 1000;
+}
+
+bool WriteFile(std::string const& path, std::string const& contents)
+{
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	file << contents;
+	return static_cast<bool>(file);
+}
+
+// Open() has to fail and leave the file as it was
+bool CheckRefused(std::string const& path, char const* what)
+{
+	std::error_code error;
+	uintmax_t sizeBefore = std::filesystem::file_size(path, error);
+	PositionDatabase database;
+	bool bOpened = database.Open(path, 16);
+	database.Close();
+	uintmax_t sizeAfter = std::filesystem::file_size(path, error);
+	if (bOpened || sizeAfter != sizeBefore)
+	{
+		std::fprintf(stderr, "%s: %s, %llu bytes before and %llu after\n", what, bOpened ? "opened" : "refused",
+			static_cast<unsigned long long>(sizeBefore), static_cast<unsigned long long>(sizeAfter));
+		return false;
+	}
+	return true;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+	int threadCount = std::max(2, static_cast<int>(std::thread::hardware_concurrency()));
+	int positionCount = 20000;
+	int repeats = 4;
+	std::string path = (std::filesystem::temp_directory_path() / "blockdrop-positions-check.bpdb").string();
+
+	ToolArgs args(argc, argv);
+	while (args.Next())
+	{
+		if (args.Option("--threads"))
+		{
+			threadCount = std::clamp(std::atoi(args.GetValue()), 1, 64);
+		}
+		else if (args.Option("--positions"))
+		{
+			positionCount = std::clamp(std::atoi(args.GetValue()), 1, 1 << 22);
+		}
+		else if (args.Option("--repeats"))
+		{
+			repeats = std::max(1, std::atoi(args.GetValue()));
+		}
+		else if (args.Option("--path"))
+		{
+			path = args.GetValue();
+		}
+		else
+		{
+			args.SetError();
+		}
+	}
+	if (args.HasError())
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	// Distinct positions: random rubble in the bottom rows and a piece
+	std::vector<Position> positions;
+	positions.reserve(positionCount);
+	std::mt19937 random(1);
+	while (static_cast<int>(positions.size()) < positionCount)
+	{
+		Position position{ PackedBoard(10, 20), static_cast<TileColor>(1 + random() % 7) };
+		for (int row = 12; row < 20; ++row)
+		{
+			for (int col = 0; col < 10; ++col)
+			{
+				position.m_Board.SetOccupied(row, col, random() % 2 == 0);
+			}
+		}
+		positions.push_back(position);
+	}
+	std::sort(positions.begin(), positions.end(), [](Position const& a, Position const& b) {
+		return a.m_Board.Hash() < b.m_Board.Hash() || (a.m_Board.Hash() == b.m_Board.Hash() && a.m_Piece < b.m_Piece);
+	});
+	positions.erase(std::unique(positions.begin(), positions.end(), [](Position const& a, Position const& b) {
+		return a.m_Board == b.m_Board && a.m_Piece == b.m_Piece;
+	}), positions.end());
+
+	std::filesystem::remove(path);
+	bool bOk = true;
+	{
+		PositionDatabase database;
+		if (!database.Open(path, positions.size() * 2))
+		{
+			std::fprintf(stderr, "Couldn't create %s\n", path.c_str());
+			return 1;
+		}
+
+		// Every thread records every position, in its own order, while one
+		// more looks positions up and checks counts never go past the total
+		std::atomic<bool> bRecording{ true };
+		std::atomic<uint64_t> badLookups{};
+		std::atomic<uint64_t> failedRecords{};
+		std::thread lookups([&] {
+			std::mt19937 lookupRandom(2);
+			while (bRecording)
+			{
+				Position const& position = positions[lookupRandom() % positions.size()];
+				PositionStats stats{};
+				if (database.Lookup(position.m_Board, position.m_Piece, stats)
+					&& stats.m_VisitCount > static_cast<uint64_t>(threadCount * repeats))
+				{
+					badLookups++;
+				}
+			}
+		});
+
+		std::vector<std::thread> threads;
+		for (int t = 0; t < threadCount; ++t)
+		{
+			threads.emplace_back([&, t] {
+				std::vector<int> order(positions.size());
+				for (int i = 0; i < static_cast<int>(order.size()); ++i)
+				{
+					order[i] = i;
+				}
+				std::shuffle(order.begin(), order.end(), std::mt19937(100 + t));
+				for (int r = 0; r < repeats; ++r)
+				{
+					for (int i : order)
+					{
+						Position const& position = positions[i];
+						TetronimoInstance placement = TetronimoFactory::New(t % 20, i % 10, position.m_Piece);
+						placement.SetRotationIndex(t % placement.GetRotationCount());
+						if (!database.Record(position.m_Board, position.m_Piece, placement, FutureScore(t, i)))
+						{
+							failedRecords++;
+						}
+					}
+				}
+			});
+		}
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+		bRecording = false;
+		lookups.join();
+		database.Flush();
+
+		if (badLookups > 0 || failedRecords > 0)
+		{
+			std::fprintf(stderr, "%llu lookups over the visit total, %llu records failed\n",
+				static_cast<unsigned long long>(badLookups.load()), static_cast<unsigned long long>(failedRecords.load()));
+			bOk = false;
+		}
+	}
+
+	// Reopened, asking for a different capacity, the file keeps its own
+	PositionDatabase database;
+	if (!database.Open(path, 16))
+	{
+		std::fprintf(stderr, "Couldn't reopen %s\n", path.c_str());
+		return 1;
+	}
+	if (database.GetEntryCount() != positions.size() || database.GetCapacity() < positions.size() * 2)
+	{
+		std::fprintf(stderr, "Reopened with %llu entries and capacity %llu, expected %zu entries\n",
+			static_cast<unsigned long long>(database.GetEntryCount()),
+			static_cast<unsigned long long>(database.GetCapacity()), positions.size());
+		bOk = false;
+	}
+
+	int badPositions = 0;
+	for (int i = 0; i < static_cast<int>(positions.size()); ++i)
+	{
+		// Scores differ between threads, so there are no ties for best
+		int bestThread = 0;
+		double sum = 0.0;
+		for (int t = 0; t < threadCount; ++t)
+		{
+			sum += FutureScore(t, i);
+			if (FutureScore(t, i) > FutureScore(bestThread, i))
+			{
+				bestThread = t;
+			}
+		}
+		TetronimoInstance best = TetronimoFactory::New(bestThread % 20, i % 10, positions[i].m_Piece);
+		best.SetRotationIndex(bestThread % best.GetRotationCount());
+
+		PositionStats stats{};
+		if (!database.Lookup(positions[i].m_Board, positions[i].m_Piece, stats)
+			|| stats.m_VisitCount != static_cast<uint64_t>(threadCount * repeats)
+			|| std::abs(stats.m_MeanFutureScore - sum / threadCount) > 1e-6
+			|| !stats.m_bHasBest
+			|| stats.m_BestFutureScore != FutureScore(bestThread, i)
+			|| stats.m_BestRotation != best.GetRotationIndex()
+			|| stats.m_BestColumn != best.GetPosition().x
+			|| stats.m_BestRow != best.GetPosition().y)
+		{
+			badPositions++;
+		}
+	}
+	database.Close();
+	if (badPositions > 0)
+	{
+		std::fprintf(stderr, "%d of %zu positions have the wrong statistics after reopening\n", badPositions, positions.size());
+		bOk = false;
+	}
+
+	// Files that aren't whole databases are refused as they are
+	std::string notDatabase = path + ".text";
+	std::string truncated = path + ".truncated";
+	WriteFile(notDatabase, "not a position database\n");
+	{
+		std::ifstream source(path, std::ios::binary);
+		std::string head(100, '\0');
+		source.read(head.data(), head.size());
+		WriteFile(truncated, head);
+	}
+	bOk = CheckRefused(notDatabase, "Text file") && bOk;
+	bOk = CheckRefused(truncated, "Truncated database") && bOk;
+
+	std::filesystem::remove(path);
+	std::filesystem::remove(notDatabase);
+	std::filesystem::remove(truncated);
+
+	if (!bOk)
+	{
+		return 1;
+	}
+	std::printf("%zu positions recorded %d times by %d threads, checked after reopening\n",
+		positions.size(), repeats, threadCount);
+	return 0;
+}
@@ -0,0 +1,145 @@
+// Renders the same scripted game with SoftwareRenderer at 1..N threads and
+// reports frames/sec for each, checking every frame matches the
+// single-threaded render.
+//
+//   raster_benchmark [--frames N] [--threads N] [--pixel-size N] [--seed N]
+//
+// --pixel-size scales the 480x640 screen up to get larger render targets.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Game.h"
+#include "HeadlessDriver.h"
+#include "Replay.h"
+#include "SoftwareRenderer.h"
+#include "ToolArgs.h"
+
+using namespace BlockDrop;
+
+namespace
+{
+
+struct RunResult
+{
+	double m_Seconds{};
+	std::vector<uint64_t> m_FrameHashes;
+};
+
+uint64_t HashFrame(olc::Pixel const* pixels, olc::vi2d size)
+{
+	// FNV-1a over whole pixels
+	uint64_t hash = 0xcbf29ce484222325ull;
+	for (int i = 0; i < size.x * size.y; ++i)
+	{
+		hash = (hash ^ pixels[i].n) * 0x100000001b3ull;
+	}
+	return hash;
+}
+
+bool Run(Replay const& replay, int pixelSize, int threadCount, RunResult& result)
+{
+	App app(replay.GetSeed());
+	HeadlessDriver driver;
+	if (!driver.Start(App::ScreenWidthPx, App::s_ScreenHeightPx, pixelSize))
+	{
+		return false;
+	}
+	SoftwareRenderer::Get()->SetThreadCount(threadCount);
+
+	using Clock = std::chrono::steady_clock;
+	Clock::duration elapsed{};
+	result.m_FrameHashes.clear();
+	for (size_t frame = 0; frame < replay.GetFrameCount(); ++frame)
+	{
+		driver.SetKeys(replay.GetKeys(frame));
+		auto start = Clock::now();
+		bool bRunning = driver.Step(replay.GetFrameTime());
+		elapsed += Clock::now() - start;
+
+		result.m_FrameHashes.push_back(HashFrame(driver.GetFrame(), driver.GetFrameSize()));
+		if (!bRunning)
+		{
+			break;
+		}
+	}
+	result.m_Seconds = std::chrono::duration<double>(elapsed).count();
+	return true;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+	size_t frameCount = 1200;
+	int maxThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+	int pixelSize = 1;
+	uint32_t seed = 1;
+
+	ToolArgs args(argc, argv);
+	while (args.Next())
+	{
+		if (args.Option("--frames"))
+		{
+			frameCount = std::strtoull(args.GetValue(), nullptr, 10);
+		}
+		else if (args.Option("--threads"))
+		{
+			maxThreads = std::max(1, std::atoi(args.GetValue()));
+		}
+		else if (args.Option("--pixel-size"))
+		{
+			pixelSize = std::max(1, std::atoi(args.GetValue()));
+		}
+		else if (args.Option("--seed"))
+		{
+			seed = static_cast<uint32_t>(std::strtoul(args.GetValue(), nullptr, 10));
+		}
+		else
+		{
+			args.SetError();
+		}
+	}
+	if (args.HasError())
+	{
+		std::fprintf(stderr, "usage: raster_benchmark [--frames N] [--threads N] [--pixel-size N] [--seed N]\n");
+		return 1;
+	}
+
+	Replay replay = Replay::MakeScripted(seed, frameCount);
+	std::printf("%zu frames at %dx%d, %d px tiles\n", frameCount,
+		App::ScreenWidthPx * pixelSize, App::s_ScreenHeightPx * pixelSize, SoftwareRenderer::s_TileSize);
+	std::printf("threads  frames/s  speedup  output\n");
+
+	RunResult baseline;
+	for (int threads = 1; threads <= maxThreads; ++threads)
+	{
+		RunResult result;
+		if (!Run(replay, pixelSize, threads, result))
+		{
+			std::fprintf(stderr, "Couldn't start the game headless\n");
+			return 1;
+		}
+		if (threads == 1)
+		{
+			baseline = result;
+		}
+
+		bool bIdentical = result.m_FrameHashes == baseline.m_FrameHashes;
+		std::printf("%7d  %8.0f  %6.2fx  %s\n", threads,
+			result.m_FrameHashes.size() / result.m_Seconds,
+			baseline.m_Seconds / result.m_Seconds,
+			bIdentical ? "identical" : "DIFFERS");
+		if (!bIdentical)
+		{
+			return 2;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,252 @@
+// Renders a replay through App's drawing code to Y4M or a PNG sequence, as
+// fast as the CPU allows.
+//
+//   replay_export [--replay FILE | --frames N --seed N] [--workers N] [--trace FILE]
+//                 [--check-allocations N] [OUTPUT]
+//
+// OUTPUT ending in .y4m writes one video stream; anything else is used as
+// the prefix of a PNG sequence. Without --replay a scripted game is played.
+// --check-allocations fails the run if a frame of play after the first N
+// heap allocates, to catch anything that breaks the zero allocation game
+// loop. Frames that enter or leave play, and menus, may allocate. With it,
+// OUTPUT can be left out to render without writing anything, as the
+// allocation test in CMakeLists.txt does.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include "AllocationCounter.h"
+#include "Game.h"
+#include "HeadlessDriver.h"
+#include "Profiler.h"
+#include "Replay.h"
+#include "ToolArgs.h"
+#include "VideoWriter.h"
+
+using namespace BlockDrop;
+
+namespace
+{
+
+void PrintUsage()
+{
+	std::fprintf(stderr,
+		"usage: replay_export [options] [OUTPUT]\n"
+		"  --replay FILE   replay to render (default: scripted game)\n"
+		"  --frames N      scripted game length (default 3600)\n"
+		"  --seed N        scripted game seed (default 1)\n"
+		"  --save FILE     also write the replay that was rendered\n"
+		"  --workers N     encoder threads (default: cores - 1)\n"
+		"  --trace FILE    write the last frames' timings as a Chrome trace\n"
+		"                  (builds with BLOCKDROP_PROFILE only)\n"
+		"  --check-allocations N\n"
+		"                  fail if a frame of play after the first N allocates\n"
+		"                  on the game's thread (builds with\n"
+		"                  BLOCKDROP_COUNT_ALLOCATIONS only)\n"
+		"OUTPUT ending in .y4m writes Y4M, otherwise a PNG sequence prefix.\n"
+		"It can be left out with --check-allocations.\n");
+}
+
+bool EndsWith(std::string const& value, char const* suffix)
+{
+	size_t length = std::strlen(suffix);
+	return value.size() >= length && value.compare(value.size() - length, length, suffix) == 0;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+	std::string replayPath;
+	std::string savePath;
+	std::string tracePath;
+	std::string outputPath;
+	size_t frameCount = 3600;
+	uint32_t seed = 1;
+	int workerCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+	bool bCheckAllocations = false;
+	size_t allocationWarmupFrames = 0;
+
+	ToolArgs args(argc, argv);
+	while (args.Next())
+	{
+		if (args.Option("--replay"))
+		{
+			replayPath = args.GetValue();
+		}
+		else if (args.Option("--save"))
+		{
+			savePath = args.GetValue();
+		}
+		else if (args.Option("--frames"))
+		{
+			frameCount = std::strtoull(args.GetValue(), nullptr, 10);
+		}
+		else if (args.Option("--seed"))
+		{
+			seed = static_cast<uint32_t>(std::strtoul(args.GetValue(), nullptr, 10));
+		}
+		else if (args.Option("--workers"))
+		{
+			workerCount = std::max(1, std::atoi(args.GetValue()));
+		}
+		else if (args.Option("--trace"))
+		{
+			tracePath = args.GetValue();
+		}
+		else if (args.Option("--check-allocations"))
+		{
+			bCheckAllocations = true;
+			allocationWarmupFrames = std::strtoull(args.GetValue(), nullptr, 10);
+		}
+		else if (args.IsPositional() && outputPath.empty())
+		{
+			outputPath = args.Get();
+		}
+		else
+		{
+			args.SetError();
+		}
+	}
+	if (args.HasError() || (outputPath.empty() && !bCheckAllocations))
+	{
+		PrintUsage();
+		return 1;
+	}
+#if !defined(BLOCKDROP_COUNT_ALLOCATIONS)
+	if (bCheckAllocations)
+	{
+		std::fprintf(stderr, "--check-allocations needs a build with BLOCKDROP_COUNT_ALLOCATIONS\n");
+		return 1;
+	}
+#endif
+
+	Replay replay;
+	if (replayPath.empty())
+	{
+		replay = Replay::MakeScripted(seed, frameCount);
+	}
+	else if (!replay.Load(replayPath))
+	{
+		std::fprintf(stderr, "Couldn't read replay %s\n", replayPath.c_str());
+		return 1;
+	}
+	if (!savePath.empty() && !replay.Save(savePath))
+	{
+		std::fprintf(stderr, "Couldn't write replay %s\n", savePath.c_str());
+		return 1;
+	}
+
+	App app(replay.GetSeed());
+	HeadlessDriver driver;
+	if (!driver.Start(App::ScreenWidthPx, App::s_ScreenHeightPx))
+	{
+		std::fprintf(stderr, "Couldn't start the game headless\n");
+		return 1;
+	}
+
+	std::optional<VideoWriter> writer;
+	if (!outputPath.empty())
+	{
+		auto format = EndsWith(outputPath, ".y4m") ? VideoWriter::Format::Y4m : VideoWriter::Format::PngSequence;
+		int frameRate = static_cast<int>(1.0f / replay.GetFrameTime() + 0.5f);
+		writer.emplace(outputPath, format, App::ScreenWidthPx, App::s_ScreenHeightPx, frameRate, workerCount);
+		if (!writer->IsOpen())
+		{
+			std::fprintf(stderr, "Couldn't open %s\n", outputPath.c_str());
+			return 1;
+		}
+	}
+
+	using Clock = std::chrono::steady_clock;
+	Clock::duration renderTime{};
+	auto start = Clock::now();
+
+	size_t framesRendered = 0;
+	int64_t pixelsTouched = 0;
+	int64_t framesUploaded = 0;
+	uint64_t allocations = 0;
+	size_t allocatingFrames = 0;
+	for (size_t frame = 0; frame < replay.GetFrameCount(); ++frame)
+	{
+		auto frameStart = Clock::now();
+		driver.SetKeys(replay.GetKeys(frame));
+		// The encoder threads allocate as they please, so only this one counts
+		AllocationScope frameAllocations(AllocationScope::Threads::Current);
+		bool bWasPlaying = app.IsPlaying();
+		bool bRunning = driver.Step(replay.GetFrameTime());
+		uint64_t frameAllocationCount = frameAllocations.GetCount();
+		renderTime += Clock::now() - frameStart;
+		bool bSteadyFrame = bWasPlaying && app.IsPlaying() && frame >= allocationWarmupFrames;
+		if (bCheckAllocations && bSteadyFrame && frameAllocationCount > 0)
+		{
+			if (allocatingFrames == 0)
+			{
+				std::fprintf(stderr, "Frame %zu made %llu heap allocations\n",
+					frame, static_cast<unsigned long long>(frameAllocationCount));
+			}
+			allocations += frameAllocationCount;
+			allocatingFrames++;
+		}
+		pixelsTouched += app.GetPixelsTouched();
+		framesUploaded += app.GetPixelsTouched() > 0 ? 1 : 0;
+
+		if (writer)
+		{
+			writer->AddFrame(driver.GetFrame());
+		}
+		framesRendered++;
+		if (!bRunning)
+		{
+			break;
+		}
+	}
+	if (writer)
+	{
+		writer->Close();
+	}
+
+	double totalSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+	double renderSeconds = std::chrono::duration<double>(renderTime).count();
+	double videoSeconds = framesRendered * replay.GetFrameTime();
+	std::printf("%zu frames (%.1f s of game) in %.2f s with %d encoder thread(s)\n",
+		framesRendered, videoSeconds, totalSeconds, workerCount);
+	std::printf("  simulate + rasterize: %.0f frames/s\n", framesRendered / renderSeconds);
+	std::printf("  end to end:           %.0f frames/s (%.1fx real time)\n",
+		framesRendered / totalSeconds, videoSeconds / totalSeconds);
+	std::printf("  layer 0: %.0f pixels touched/frame, uploaded on %.1f%% of frames\n",
+		static_cast<double>(pixelsTouched) / framesRendered, 100.0 * framesUploaded / framesRendered);
+	if (writer)
+	{
+		std::printf("  wrote %llu frames, %.1f MiB\n",
+			static_cast<unsigned long long>(writer->GetFramesWritten()), writer->GetBytesWritten() / (1024.0 * 1024.0));
+	}
+
+	if (bCheckAllocations)
+	{
+		std::printf("  heap allocations in play after frame %zu: %llu, in %zu frames\n",
+			allocationWarmupFrames, static_cast<unsigned long long>(allocations), allocatingFrames);
+	}
+
+	if (!tracePath.empty())
+	{
+#if defined(BLOCKDROP_PROFILE)
+		if (!Profiler::WriteChromeTrace(tracePath))
+		{
+			std::fprintf(stderr, "Couldn't write %s\n", tracePath.c_str());
+			return 1;
+		}
+#else
+		std::fprintf(stderr, "--trace needs a build with BLOCKDROP_PROFILE\n");
+		return 1;
+#endif
+	}
+
+	return allocatingFrames == 0 ? 0 : 1;
+}
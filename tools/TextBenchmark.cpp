@@ -0,0 +1,138 @@
+// Compares olc's DrawString with GlyphCache's per-glyph and whole-string
+// span paths, in characters/sec, and checks all three draw the same pixels.
+//
+//   text_benchmark [--chars N]
+//
+// Each case draws at least N characters (default 2000000).
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "olcPixelGameEngine.h"
+
+#include "Game.h"
+#include "GlyphCache.h"
+#include "HeadlessDriver.h"
+#include "ToolArgs.h"
+
+using namespace BlockDrop;
+
+namespace
+{
+
+class TextEngine : public olc::PixelGameEngine
+{
+public:
+	bool OnUserCreate() override { return true; }
+	bool OnUserUpdate(float) override { return true; }
+};
+
+struct TextCase
+{
+	char const* m_Text;
+	uint32_t m_Scale;
+};
+
+// The strings and scales App draws
+TextCase const s_Cases[] = {
+	{ "and Paul Raccuglia", 1 },
+	{ "Score:", 2 },
+	{ "1234567", 2 },
+	{ "[Space]", 2 },
+	{ "SCORES", 3 },
+	{ "Exit?", 4 },
+};
+
+template <typename Fn>
+double Measure(int64_t targetChars, size_t charsPerCall, Fn&& draw)
+{
+	int64_t calls = std::max<int64_t>(1, targetChars / static_cast<int64_t>(charsPerCall));
+
+	using Clock = std::chrono::steady_clock;
+	auto start = Clock::now();
+	for (int64_t i = 0; i < calls; ++i)
+	{
+		draw();
+	}
+	double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+	return static_cast<double>(calls * charsPerCall) / seconds;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+	int64_t targetChars = 2000000;
+	ToolArgs args(argc, argv);
+	while (args.Next())
+	{
+		if (args.Option("--chars"))
+		{
+			targetChars = std::max<int64_t>(1, std::atoll(args.GetValue()));
+		}
+		else
+		{
+			args.SetError();
+		}
+	}
+	if (args.HasError())
+	{
+		std::fprintf(stderr, "usage: text_benchmark [--chars N]\n");
+		return 1;
+	}
+
+	TextEngine engine;
+	HeadlessDriver driver;
+	if (!driver.Start(App::ScreenWidthPx, App::s_ScreenHeightPx))
+	{
+		std::fprintf(stderr, "Couldn't start the engine headless\n");
+		return 1;
+	}
+
+	GlyphCache cache;
+	olc::vi2d const pos{ 20, 20 };
+	olc::Sprite* target = engine.GetDrawTarget();
+	size_t const pixelCount = static_cast<size_t>(target->width) * target->height;
+	auto snapshot = [&]() {
+		return std::vector<olc::Pixel>(target->GetData(), target->GetData() + pixelCount);
+	};
+
+	std::printf("%-20s %5s %12s %12s %12s\n", "text", "scale", "DrawString", "glyphs", "static");
+	for (TextCase const& c : s_Cases)
+	{
+		std::string text = c.m_Text;
+
+		engine.Clear(olc::BLANK);
+		engine.DrawString(pos, text, olc::WHITE, c.m_Scale);
+		auto expected = snapshot();
+		engine.Clear(olc::BLANK);
+		cache.DrawString(engine, pos, text, olc::WHITE, c.m_Scale);
+		bool bGlyphsMatch = snapshot() == expected;
+		engine.Clear(olc::BLANK);
+		cache.DrawStaticString(engine, pos, text, olc::WHITE, c.m_Scale);
+		bool bStaticMatch = snapshot() == expected;
+		if (!bGlyphsMatch || !bStaticMatch)
+		{
+			std::fprintf(stderr, "\"%s\" at scale %u differs from DrawString\n", c.m_Text, c.m_Scale);
+			return 2;
+		}
+
+		double olcRate = Measure(targetChars, text.size(), [&]() {
+			engine.DrawString(pos, text, olc::WHITE, c.m_Scale);
+		});
+		double glyphRate = Measure(targetChars, text.size(), [&]() {
+			cache.DrawString(engine, pos, text, olc::WHITE, c.m_Scale);
+		});
+		double staticRate = Measure(targetChars, text.size(), [&]() {
+			cache.DrawStaticString(engine, pos, text, olc::WHITE, c.m_Scale);
+		});
+		std::printf("%-20s %5u %10.1fM %10.1fM %10.1fM  chars/s\n",
+			c.m_Text, c.m_Scale, olcRate / 1e6, glyphRate / 1e6, staticRate / 1e6);
+	}
+
+	return 0;
+}
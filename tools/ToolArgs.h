@@ -0,0 +1,76 @@
+#pragma once
+#ifndef BLOCKDROP_TOOL_ARGS_H
+#define BLOCKDROP_TOOL_ARGS_H
+
+#include <cstring>
+
+namespace BlockDrop
+{
+
+// Command-line parsing for the tools: "--name value" options in any order,
+// plus positional arguments for tools that take them. An option without a
+// value, an unknown option or a stray argument is an error, so a typo fails
+// with usage instead of quietly running with defaults.
+//
+//   ToolArgs args(argc, argv);
+//   while (args.Next())
+//   {
+//       if (args.Option("--frames")) frameCount = std::strtoull(args.GetValue(), nullptr, 10);
+//       else if (args.IsPositional() && outputPath.empty()) outputPath = args.Get();
+//       else args.SetError();
+//   }
+//   if (args.HasError()) { PrintUsage(); return 1; }
+class ToolArgs
+{
+public:
+	ToolArgs(int argc, char** argv)
+		: m_Argc(argc)
+		, m_Argv(argv)
+	{
+	}
+
+	// Moves to the next argument; false after the last one or an error
+	bool Next()
+	{
+		m_Value = nullptr;
+		return !m_bError && ++m_Index < m_Argc;
+	}
+
+	char const* Get() const { return m_Argv[m_Index]; }
+
+	// Whether the argument is the option name, taking the value after it. An
+	// option given last, or followed by another option, is missing its value
+	// and an error.
+	bool Option(char const* name)
+	{
+		if (std::strcmp(Get(), name) != 0)
+		{
+			return false;
+		}
+		if (m_Index + 1 >= m_Argc || std::strncmp(m_Argv[m_Index + 1], "--", 2) == 0)
+		{
+			m_bError = true;
+			return false;
+		}
+		m_Value = m_Argv[++m_Index];
+		return true;
+	}
+	char const* GetValue() const { return m_Value; }
+
+	bool IsPositional() const { return Get()[0] != '-'; }
+
+	// The argument wasn't expected
+	void SetError() { m_bError = true; }
+	bool HasError() const { return m_bError; }
+
+private:
+	int m_Argc;
+	char** m_Argv;
+	int m_Index{ 0 };
+	char const* m_Value{};
+	bool m_bError{ false };
+};
+
+}
+
+#endif
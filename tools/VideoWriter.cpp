@@ -0,0 +1,241 @@
+#include "VideoWriter.h"
+
+#include <algorithm>
+#include <csetjmp>
+#include <cstdio>
+#include <cstring>
+
+#include <png.h>
+
+namespace BlockDrop
+{
+
+VideoWriter::VideoWriter(std::string const& path, Format format, int width, int height, int frameRate, int workerCount)
+	: m_Path(path)
+	, m_Format(format)
+	, m_Width(width)
+	, m_Height(height)
+{
+	if (m_Format == Format::Y4m)
+	{
+		m_Stream.open(m_Path, std::ios::binary | std::ios::trunc);
+		if (!m_Stream)
+		{
+			return;
+		}
+
+		// C420jpeg: full-range BT.601, chroma centred between luma samples
+		char header[128];
+		int size = std::snprintf(header, sizeof(header), "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", m_Width, m_Height, frameRate);
+		m_Stream.write(header, size);
+		m_BytesWritten += size;
+	}
+	m_bOpen = true;
+
+	workerCount = std::max(1, workerCount);
+	// Two buffers per worker keeps every worker busy while the caller fills
+	// the next frame
+	for (int i = 0; i < workerCount * 2 + 1; ++i)
+	{
+		auto frame = std::make_unique<Frame>();
+		frame->m_Pixels.resize(static_cast<size_t>(m_Width) * m_Height);
+		m_Free.push_back(std::move(frame));
+	}
+	for (int i = 0; i < workerCount; ++i)
+	{
+		m_Workers.emplace_back(&VideoWriter::WorkerLoop, this);
+	}
+}
+
+VideoWriter::~VideoWriter()
+{
+	Close();
+}
+
+void VideoWriter::AddFrame(olc::Pixel const* pixels)
+{
+	if (!m_bOpen)
+	{
+		return;
+	}
+
+	std::unique_ptr<Frame> frame;
+	{
+		std::unique_lock lock(m_Mutex);
+		m_FrameFree.wait(lock, [this] { return !m_Free.empty(); });
+		frame = std::move(m_Free.back());
+		m_Free.pop_back();
+	}
+
+	std::copy_n(pixels, frame->m_Pixels.size(), frame->m_Pixels.begin());
+
+	{
+		std::lock_guard lock(m_Mutex);
+		frame->m_Index = m_NextIndex++;
+		m_Pending.push_back(std::move(frame));
+	}
+	m_WorkReady.notify_one();
+}
+
+void VideoWriter::Close()
+{
+	{
+		std::lock_guard lock(m_Mutex);
+		if (m_bClosing)
+		{
+			return;
+		}
+		m_bClosing = true;
+	}
+
+	m_WorkReady.notify_all();
+	for (auto& worker : m_Workers)
+	{
+		worker.join();
+	}
+	m_Workers.clear();
+	m_Stream.close();
+}
+
+void VideoWriter::WorkerLoop()
+{
+	while (true)
+	{
+		std::unique_ptr<Frame> frame;
+		{
+			std::unique_lock lock(m_Mutex);
+			m_WorkReady.wait(lock, [this] { return !m_Pending.empty() || m_bClosing; });
+			if (m_Pending.empty())
+			{
+				return;
+			}
+			frame = std::move(m_Pending.front());
+			m_Pending.pop_front();
+		}
+
+		if (m_Format == Format::Y4m)
+		{
+			EncodeY4m(*frame);
+
+			// Frames finish out of order; the stream takes them in order
+			std::unique_lock lock(m_Mutex);
+			m_WriteTurn.wait(lock, [&] { return m_NextWrite == frame->m_Index; });
+			m_Stream.write(reinterpret_cast<char const*>(frame->m_Encoded.data()), frame->m_Encoded.size());
+			m_NextWrite++;
+			m_FramesWritten++;
+			m_BytesWritten += frame->m_Encoded.size();
+		}
+		else if (EncodePng(*frame))
+		{
+			char suffix[16];
+			std::snprintf(suffix, sizeof(suffix), "-%06llu.png", static_cast<unsigned long long>(frame->m_Index));
+			std::ofstream file(m_Path + suffix, std::ios::binary | std::ios::trunc);
+			file.write(reinterpret_cast<char const*>(frame->m_Encoded.data()), frame->m_Encoded.size());
+
+			std::lock_guard lock(m_Mutex);
+			m_FramesWritten++;
+			m_BytesWritten += frame->m_Encoded.size();
+		}
+
+		{
+			std::lock_guard lock(m_Mutex);
+			m_Free.push_back(std::move(frame));
+		}
+		m_WriteTurn.notify_all();
+		m_FrameFree.notify_one();
+	}
+}
+
+void VideoWriter::EncodeY4m(Frame& frame) const
+{
+	static constexpr char s_FrameHeader[] = "FRAME\n";
+	static constexpr size_t s_FrameHeaderSize = sizeof(s_FrameHeader) - 1;
+
+	int chromaWidth = (m_Width + 1) / 2;
+	int chromaHeight = (m_Height + 1) / 2;
+	size_t lumaSize = static_cast<size_t>(m_Width) * m_Height;
+	size_t chromaSize = static_cast<size_t>(chromaWidth) * chromaHeight;
+	frame.m_Encoded.resize(s_FrameHeaderSize + lumaSize + 2 * chromaSize);
+
+	uint8_t* y = frame.m_Encoded.data();
+	std::memcpy(y, s_FrameHeader, s_FrameHeaderSize);
+	y += s_FrameHeaderSize;
+	uint8_t* u = y + lumaSize;
+	uint8_t* v = u + chromaSize;
+
+	// Full-range BT.601 in 8.8 fixed point
+	olc::Pixel const* pixels = frame.m_Pixels.data();
+	for (size_t i = 0; i < lumaSize; ++i)
+	{
+		olc::Pixel p = pixels[i];
+		y[i] = static_cast<uint8_t>((77 * p.r + 150 * p.g + 29 * p.b + 128) >> 8);
+	}
+
+	for (int cy = 0; cy < chromaHeight; ++cy)
+	{
+		int row0 = cy * 2;
+		int row1 = std::min(row0 + 1, m_Height - 1);
+		for (int cx = 0; cx < chromaWidth; ++cx)
+		{
+			int col0 = cx * 2;
+			int col1 = std::min(col0 + 1, m_Width - 1);
+			olc::Pixel quad[4] = {
+				pixels[row0 * m_Width + col0], pixels[row0 * m_Width + col1],
+				pixels[row1 * m_Width + col0], pixels[row1 * m_Width + col1],
+			};
+			int r = 0, g = 0, b = 0;
+			for (olc::Pixel p : quad)
+			{
+				r += p.r;
+				g += p.g;
+				b += p.b;
+			}
+			// Sums of four, so shift by 10 instead of 8
+			u[cy * chromaWidth + cx] = static_cast<uint8_t>(((-43 * r - 85 * g + 128 * b + 512) >> 10) + 128);
+			v[cy * chromaWidth + cx] = static_cast<uint8_t>(((128 * r - 107 * g - 21 * b + 512) >> 10) + 128);
+		}
+	}
+}
+
+bool VideoWriter::EncodePng(Frame& frame) const
+{
+	frame.m_Encoded.clear();
+
+	png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+	if (png == nullptr)
+	{
+		return false;
+	}
+	png_infop info = png_create_info_struct(png);
+	if (info == nullptr || setjmp(png_jmpbuf(png)))
+	{
+		png_destroy_write_struct(&png, &info);
+		return false;
+	}
+
+	png_set_write_fn(png, &frame.m_Encoded,
+		[](png_structp png, png_bytep data, png_size_t length) {
+			auto* out = static_cast<std::vector<uint8_t>*>(png_get_io_ptr(png));
+			out->insert(out->end(), data, data + length);
+		},
+		nullptr);
+
+	// Frames are mostly flat colour, so the fastest zlib level loses little
+	png_set_compression_level(png, 1);
+	png_set_IHDR(png, info, m_Width, m_Height, 8, PNG_COLOR_TYPE_RGB, PNG_INTERLACE_NONE,
+		PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+	png_write_info(png, info);
+
+	// olc::Pixel is RGBA in memory; drop the alpha byte
+	png_set_filler(png, 0, PNG_FILLER_AFTER);
+	for (int row = 0; row < m_Height; ++row)
+	{
+		png_write_row(png, reinterpret_cast<png_bytep>(const_cast<olc::Pixel*>(&frame.m_Pixels[row * m_Width])));
+	}
+
+	png_write_end(png, nullptr);
+	png_destroy_write_struct(&png, &info);
+	return true;
+}
+
+}
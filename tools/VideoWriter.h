@@ -0,0 +1,91 @@
+#pragma once
+#ifndef BLOCKDROP_VIDEO_WRITER_H
+#define BLOCKDROP_VIDEO_WRITER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "olcPixelGameEngine.h"
+
+namespace BlockDrop
+{
+
+// Encodes frames on worker threads while the caller renders the next ones.
+//
+// Y4M writes one uncompressed 4:2:0 stream to `path`; frames are converted
+// in parallel and written in order. PngSequence writes <path>-000000.png,
+// <path>-000001.png, ... independently.
+//
+// AddFrame() copies the frame and returns. It only waits when every frame
+// buffer is still queued, which bounds memory if encoding falls behind.
+class VideoWriter
+{
+public:
+	enum class Format
+	{
+		Y4m,
+		PngSequence,
+	};
+
+public:
+	VideoWriter(std::string const& path, Format format, int width, int height, int frameRate, int workerCount);
+	VideoWriter(VideoWriter&) = delete;
+	~VideoWriter();
+
+	bool IsOpen() const { return m_bOpen; }
+
+	void AddFrame(olc::Pixel const* pixels);
+
+	// Waits for every queued frame to be written
+	void Close();
+
+	uint64_t GetFramesWritten() const { return m_FramesWritten; }
+	uint64_t GetBytesWritten() const { return m_BytesWritten; }
+
+private:
+	struct Frame
+	{
+		uint64_t m_Index{};
+		std::vector<olc::Pixel> m_Pixels;
+		std::vector<uint8_t> m_Encoded;
+	};
+
+private:
+	void WorkerLoop();
+	void EncodeY4m(Frame& frame) const;
+	bool EncodePng(Frame& frame) const;
+
+private:
+	std::string m_Path;
+	Format m_Format;
+	int m_Width;
+	int m_Height;
+	bool m_bOpen{ false };
+
+	std::ofstream m_Stream;
+
+	std::mutex m_Mutex;
+	std::condition_variable m_WorkReady;
+	std::condition_variable m_FrameFree;
+	std::condition_variable m_WriteTurn;
+	std::deque<std::unique_ptr<Frame>> m_Pending;
+	std::vector<std::unique_ptr<Frame>> m_Free;
+	uint64_t m_NextIndex{};
+	uint64_t m_NextWrite{};
+	bool m_bClosing{ false };
+	std::vector<std::thread> m_Workers;
+
+	uint64_t m_FramesWritten{};
+	uint64_t m_BytesWritten{};
+};
+
+}
+
+#endif